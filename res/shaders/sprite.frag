@@ -0,0 +1,11 @@
+#version 450
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) flat in uint fragAtlasIndex;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // fragAtlasIndex selects the atlas tile once texture sampling is hooked up
+    outColor = vec4(fragColor, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 2) in vec2 instancePosition;
+layout(location = 3) in uint instanceAtlasIndex;
+layout(location = 4) in vec4 instanceTint;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) flat out uint fragAtlasIndex;
+
+// no depth test, layers are drawn in order
+void main() {
+    gl_Position = vec4(inPosition + instancePosition, 0.0, 1.0);
+    fragColor = inColor * instanceTint.rgb;
+    fragAtlasIndex = instanceAtlasIndex;
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 #!/bin/bash
 
 glslc res/shaders/shader.vert -o res/shaders/output/vert.spv
-glslc res/shaders/shader.frag -o res/shaders/output/frag.spv
\ No newline at end of file
+glslc res/shaders/shader.frag -o res/shaders/output/frag.spv
+glslc res/shaders/sprite.vert -o res/shaders/output/sprite_vert.spv
+glslc res/shaders/sprite.frag -o res/shaders/output/sprite_frag.spv
\ No newline at end of file
@@ -0,0 +1,182 @@
+// checks flow fields against Dijkstra over the whole map, on a map with scattered walls and on a winding one whose
+// costs don't fit in 16 bits, and that edits drop exactly the fields they should
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "Sim/FlowField.h"
+#include "Sim/PathFinder.h"
+#include "Sim/TileMap.h"
+#include "Utils/JobSystem.hpp"
+
+namespace
+{
+constexpr int mapSize = 256;
+constexpr int targetCount = 20;
+
+// cost from every tile to target with PathFinder's steps, unreachable where there is no path
+std::vector<uint32_t> dijkstra(const TileMap& map, glm::ivec2 target)
+{
+	std::vector<uint32_t> costs(mapSize * mapSize, FlowField::unreachable);
+	if (!map.isWalkable(target))
+		return costs;
+
+	using Entry = std::pair<uint32_t, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open;
+	costs[target.y * mapSize + target.x] = 0;
+	open.push({ 0, target.y * mapSize + target.x });
+
+	while (!open.empty())
+	{
+		const auto [cost, tile] = open.top();
+		open.pop();
+		if (cost != costs[tile])
+			continue;
+
+		const int x = tile % mapSize;
+		const int y = tile / mapSize;
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if ((dx == 0 && dy == 0) || !map.isWalkable({ x + dx, y + dy }))
+					continue;
+
+				const bool diagonal = dx != 0 && dy != 0;
+				if (diagonal && (!map.isWalkable({ x + dx, y }) || !map.isWalkable({ x, y + dy })))
+					continue;
+
+				const uint32_t next = cost + (diagonal ? PathFinder::diagonalCost : PathFinder::straightCost);
+				const int index = (y + dy) * mapSize + x + dx;
+				if (next < costs[index])
+				{
+					costs[index] = next;
+					open.push({ next, index });
+				}
+			}
+		}
+	}
+
+	return costs;
+}
+
+// every cost matches and every direction steps to a neighbour exactly one step cheaper, returns the mismatches
+int compare(const TileMap& map, const FlowField& field)
+{
+	const std::vector<uint32_t> expected = dijkstra(map, field.getTarget());
+
+	int mismatches = 0;
+	for (int index = 0; index < mapSize * mapSize; index++)
+	{
+		const glm::ivec2 tile = { index % mapSize, index / mapSize };
+		const uint32_t cost = field.getCost(tile);
+		if (cost != expected[index])
+		{
+			mismatches++;
+			continue;
+		}
+
+		if (cost == FlowField::unreachable || cost == 0)
+			continue;
+
+		const glm::ivec2 direction = field.getDirection(tile);
+		const uint32_t step = direction.x != 0 && direction.y != 0 ? PathFinder::diagonalCost : PathFinder::straightCost;
+		if (direction == glm::ivec2(0, 0) || field.getCost(tile + direction) + step != cost)
+			mismatches++;
+	}
+	return mismatches;
+}
+
+int report(const char* check, bool passed)
+{
+	if (!passed)
+		std::printf("%s failed\n", check);
+	return passed ? 0 : 1;
+}
+} // namespace
+
+int main()
+{
+	JobSystem::Init();
+	std::mt19937 rng(9);
+	const auto randomTile = [&rng] { return glm::ivec2(static_cast<int>(rng() % mapSize), static_cast<int>(rng() % mapSize)); };
+
+	// wall segments and rock scattered over grass
+	TileMap map;
+	map.create(mapSize, mapSize, Terrain::Grass);
+	for (int i = 0; i < 200; i++)
+	{
+		const glm::ivec2 start = randomTile();
+		const bool horizontal = rng() % 2 == 0;
+		const int length = 5 + static_cast<int>(rng() % 40);
+		for (int j = 0; j < length; j++)
+		{
+			const glm::ivec2 tile = horizontal ? glm::ivec2(start.x + j, start.y) : glm::ivec2(start.x, start.y + j);
+			if (map.isInBounds(tile))
+				map.setFlag(tile, TileFlag::Wall, true);
+		}
+	}
+	for (int i = 0; i < 2000; i++)
+		map.setTerrain(randomTile(), Terrain::Rock);
+	map.clearDirty();
+
+	FlowFieldCache cache;
+	cache.create(map, 4);
+
+	int failures = 0;
+	for (int i = 0; i < targetCount; i++)
+	{
+		const glm::ivec2 target = randomTile();
+		const int mismatches = compare(map, *cache.getField(target));
+		if (mismatches > 0)
+			std::printf("field to (%d, %d) has %d tiles that differ from Dijkstra\n", target.x, target.y, mismatches);
+		failures += mismatches > 0;
+	}
+
+	const auto edit = [&](glm::ivec2 tile, TileFlag flag, bool value) {
+		map.setFlag(tile, flag, value);
+		cache.update(map.getDirtyChunks());
+		map.clearDirty();
+	};
+
+	const std::shared_ptr<const FlowField> field = cache.getField({ 5, 5 });
+	failures += report("cached field reused", cache.getField({ 5, 5 }) == field);
+	edit({ 200, 200 }, TileFlag::Roof, true);
+	failures += report("roof keeps the field", cache.getField({ 5, 5 }) == field);
+	edit({ 6, 6 }, TileFlag::Wall, true);
+	failures += report("wall drops the field", cache.getField({ 5, 5 }) != field);
+
+	// a field to a blocked target has to be rebuilt once the target is walkable again
+	edit({ 40, 40 }, TileFlag::Wall, true);
+	const std::shared_ptr<const FlowField> blocked = cache.getField({ 40, 40 });
+	edit({ 40, 40 }, TileFlag::Wall, false);
+	const std::shared_ptr<const FlowField> unblocked = cache.getField({ 40, 40 });
+	failures += report("clearing a blocked target rebuilds its field", unblocked != blocked && compare(map, *unblocked) == 0);
+
+	// rows of walls with one gap at alternating ends, the far corner is more than 300000 away
+	TileMap winding;
+	winding.create(mapSize, mapSize, Terrain::Grass);
+	for (int y = 1; y < mapSize; y += 2)
+	{
+		const int gap = (y / 2) % 2 == 0 ? mapSize - 1 : 0;
+		for (int x = 0; x < mapSize; x++)
+		{
+			if (x != gap)
+				winding.setFlag({ x, y }, TileFlag::Wall, true);
+		}
+	}
+	winding.clearDirty();
+
+	FlowFieldCache windingCache;
+	windingCache.create(winding, 1);
+	failures += report("winding map matches Dijkstra", compare(winding, *windingCache.getField({ 0, 0 })) == 0);
+
+	JobSystem::Shutdown();
+
+	std::printf("%d flow field checks failed, %llu fields built\n", failures, static_cast<unsigned long long>(cache.getBuildCount()));
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+// checks PathFinder against Dijkstra over the whole map, with random edits fed through update between rounds and
+// requests between the same chunks repeated so cached stretches get reused for other endpoints
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "Sim/PathFinder.h"
+#include "Sim/TileMap.h"
+#include "Utils/JobSystem.hpp"
+
+namespace
+{
+constexpr int mapSize = 256;
+constexpr int rounds = 200;
+constexpr int requestsPerRound = 20;
+
+// cached stretches are only reused within PathFinder::maxShortcutCost of the heuristic, so a hit is never
+// further off than that. a full abstract search has no hard bound, entrances sit where the borders put them
+constexpr double maxHitRatio = 1.2;
+constexpr double maxRatio = 2.0;
+constexpr double maxMeanRatio = 1.05;
+
+constexpr uint32_t unreachable = UINT32_MAX;
+
+// exact cost from start to goal with PathFinder's steps, unreachable if there is no path
+uint32_t dijkstra(const TileMap& map, glm::ivec2 start, glm::ivec2 goal)
+{
+	if (!map.isWalkable(start) || !map.isWalkable(goal))
+		return unreachable;
+
+	std::vector<uint32_t> costs(mapSize * mapSize, unreachable);
+	using Entry = std::pair<uint32_t, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open;
+	costs[start.y * mapSize + start.x] = 0;
+	open.push({ 0, start.y * mapSize + start.x });
+
+	while (!open.empty())
+	{
+		const auto [cost, tile] = open.top();
+		open.pop();
+		if (cost != costs[tile])
+			continue;
+
+		const int x = tile % mapSize;
+		const int y = tile / mapSize;
+		if (x == goal.x && y == goal.y)
+			return cost;
+
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if ((dx == 0 && dy == 0) || !map.isWalkable({ x + dx, y + dy }))
+					continue;
+
+				const bool diagonal = dx != 0 && dy != 0;
+				if (diagonal && (!map.isWalkable({ x + dx, y }) || !map.isWalkable({ x, y + dy })))
+					continue;
+
+				const uint32_t next = cost + (diagonal ? PathFinder::diagonalCost : PathFinder::straightCost);
+				const int index = (y + dy) * mapSize + x + dx;
+				if (next < costs[index])
+				{
+					costs[index] = next;
+					open.push({ next, index });
+				}
+			}
+		}
+	}
+
+	return unreachable;
+}
+
+// cost of the path if every step is a legal move, unreachable otherwise
+uint32_t getLegalCost(const TileMap& map, const std::vector<glm::ivec2>& path)
+{
+	uint32_t cost = 0;
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		const glm::ivec2 from = path[i - 1];
+		const glm::ivec2 to = path[i];
+		const int dx = std::abs(to.x - from.x);
+		const int dy = std::abs(to.y - from.y);
+		if (dx > 1 || dy > 1 || dx + dy == 0 || !map.isWalkable(to))
+			return unreachable;
+
+		const bool diagonal = dx != 0 && dy != 0;
+		if (diagonal && (!map.isWalkable({ to.x, from.y }) || !map.isWalkable({ from.x, to.y })))
+			return unreachable;
+
+		cost += diagonal ? PathFinder::diagonalCost : PathFinder::straightCost;
+	}
+	return cost;
+}
+} // namespace
+
+int main()
+{
+	JobSystem::Init();
+	std::mt19937 rng(3);
+	const auto randomTile = [&rng] { return glm::ivec2(static_cast<int>(rng() % mapSize), static_cast<int>(rng() % mapSize)); };
+	const auto randomOffset = [&rng] { return glm::ivec2(static_cast<int>(rng() % 9) - 4, static_cast<int>(rng() % 9) - 4); };
+
+	// rock blobs and wall segments over grass
+	TileMap map;
+	map.create(mapSize, mapSize, Terrain::Grass);
+	for (int i = 0; i < 64; i++)
+	{
+		const glm::ivec2 center = randomTile();
+		const int radius = 2 + i % 7;
+		for (int y = center.y - radius; y <= center.y + radius; y++)
+		{
+			for (int x = center.x - radius; x <= center.x + radius; x++)
+			{
+				if (map.isInBounds({ x, y }) && (x - center.x) * (x - center.x) + (y - center.y) * (y - center.y) <= radius * radius)
+					map.setTerrain({ x, y }, Terrain::Rock);
+			}
+		}
+	}
+	for (int i = 0; i < 200; i++)
+	{
+		const glm::ivec2 start = randomTile();
+		const bool horizontal = rng() % 2 == 0;
+		const int length = 5 + static_cast<int>(rng() % 30);
+		for (int j = 0; j < length; j++)
+		{
+			const glm::ivec2 tile = horizontal ? glm::ivec2(start.x + j, start.y) : glm::ivec2(start.x, start.y + j);
+			if (map.isInBounds(tile))
+				map.setFlag(tile, TileFlag::Wall, true);
+		}
+	}
+	map.clearDirty();
+
+	PathFinder pathFinder;
+	pathFinder.create(map);
+
+	int failures = 0;
+	const auto fail = [&failures](const char* reason, glm::ivec2 start, glm::ivec2 goal) {
+		if (failures++ < 10)
+			std::printf("(%d, %d) to (%d, %d): %s\n", start.x, start.y, goal.x, goal.y, reason);
+	};
+
+	std::vector<glm::ivec2> path;
+	double ratioSum = 0.0;
+	double worstRatio = 1.0;
+	int pathCount = 0;
+
+	for (int round = 0; round < rounds; round++)
+	{
+		// single walls toggled and stretches of wall rebuilt with gaps
+		for (int edit = 0; edit < 5; edit++)
+		{
+			const glm::ivec2 tile = randomTile();
+			if (rng() % 2 == 0)
+			{
+				map.setFlag(tile, TileFlag::Wall, !map.hasFlag(tile, TileFlag::Wall));
+				continue;
+			}
+
+			const bool horizontal = rng() % 2 == 0;
+			for (int i = 0; i < 15; i++)
+			{
+				const glm::ivec2 wall = horizontal ? glm::ivec2(tile.x + i, tile.y) : glm::ivec2(tile.x, tile.y + i);
+				if (map.isInBounds(wall))
+					map.setFlag(wall, TileFlag::Wall, rng() % 3 == 0);
+			}
+		}
+		pathFinder.update(map.getDirtyChunks());
+		map.clearDirty();
+
+		// every other request is near the same two tiles, so later ones hit the stretch cached by earlier ones
+		const glm::ivec2 from = randomTile();
+		const glm::ivec2 to = randomTile();
+		for (int request = 0; request < requestsPerRound; request++)
+		{
+			const bool repeated = request % 2 == 1;
+			const glm::ivec2 start = repeated ? from + randomOffset() : randomTile();
+			const glm::ivec2 goal = repeated ? to + randomOffset() : randomTile();
+			if (!map.isInBounds(start) || !map.isInBounds(goal))
+				continue;
+
+			const uint64_t hits = pathFinder.getCacheHits();
+			const bool found = pathFinder.findPath(start, goal, path);
+			const bool hit = pathFinder.getCacheHits() != hits;
+			const uint32_t expected = dijkstra(map, start, goal);
+
+			if (found != (expected != unreachable))
+			{
+				fail(found ? "found a path Dijkstra says doesn't exist" : "no path although Dijkstra found one", start, goal);
+				continue;
+			}
+			if (!found)
+				continue;
+
+			if (path.empty() || path.front() != start || path.back() != goal)
+			{
+				fail("path doesn't run from start to goal", start, goal);
+				continue;
+			}
+
+			const uint32_t cost = getLegalCost(map, path);
+			if (cost == unreachable)
+			{
+				fail("path has an illegal step", start, goal);
+				continue;
+			}
+			if (expected == 0)
+				continue;
+
+			const double ratio = static_cast<double>(cost) / expected;
+			if (ratio > (hit ? maxHitRatio : maxRatio))
+				fail(hit ? "cached path too long" : "path too long", start, goal);
+
+			ratioSum += ratio;
+			worstRatio = std::max(worstRatio, ratio);
+			pathCount++;
+		}
+	}
+
+	JobSystem::Shutdown();
+
+	const double meanRatio = pathCount > 0 ? ratioSum / pathCount : 1.0;
+	if (meanRatio > maxMeanRatio)
+	{
+		std::printf("mean cost %.3fx the shortest, more than %.2fx\n", meanRatio, maxMeanRatio);
+		failures++;
+	}
+
+	std::printf("%d failures, %d paths, mean %.3fx and worst %.3fx the shortest, %llu cache hits\n", failures, pathCount, meanRatio, worstRatio,
+				static_cast<unsigned long long>(pathFinder.getCacheHits()));
+	return failures == 0 ? 0 : 1;
+}
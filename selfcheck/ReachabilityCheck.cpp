@@ -0,0 +1,148 @@
+// checks Reachability against a flood fill of the whole map after every one of a few thousand random edits
+
+#include <cstdio>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "Sim/Reachability.h"
+#include "Sim/TileMap.h"
+#include "Utils/JobSystem.hpp"
+
+namespace
+{
+constexpr int mapSize = 128;
+constexpr int editRounds = 3000;
+
+// component of every tile by breadth first search, -1 where it isn't walkable
+std::vector<int> floodComponents(const TileMap& map, int& componentCount)
+{
+	std::vector<int> components(mapSize * mapSize, -1);
+	componentCount = 0;
+
+	for (int start = 0; start < mapSize * mapSize; start++)
+	{
+		if (components[start] >= 0 || !map.isWalkable({ start % mapSize, start / mapSize }))
+			continue;
+
+		std::queue<int> open;
+		open.push(start);
+		components[start] = componentCount;
+		while (!open.empty())
+		{
+			const int tile = open.front();
+			open.pop();
+
+			const int x = tile % mapSize;
+			const int y = tile / mapSize;
+			const glm::ivec2 neighbours[4] = { { x + 1, y }, { x - 1, y }, { x, y + 1 }, { x, y - 1 } };
+			for (glm::ivec2 neighbour : neighbours)
+			{
+				if (!map.isWalkable(neighbour))
+					continue;
+
+				const int index = neighbour.y * mapSize + neighbour.x;
+				if (components[index] < 0)
+				{
+					components[index] = componentCount;
+					open.push(index);
+				}
+			}
+		}
+		componentCount++;
+	}
+
+	return components;
+}
+
+// the index must give the same partition as the flood, ids may differ
+bool matches(const TileMap& map, const Reachability& reachability)
+{
+	int componentCount = 0;
+	const std::vector<int> expected = floodComponents(map, componentCount);
+
+	std::vector<uint32_t> toIndex(componentCount, Reachability::invalid);
+	std::unordered_map<uint32_t, int> toFlood;
+	for (int tile = 0; tile < mapSize * mapSize; tile++)
+	{
+		const uint32_t component = reachability.getComponent({ tile % mapSize, tile / mapSize });
+		if (expected[tile] < 0 || component == Reachability::invalid)
+		{
+			if (expected[tile] >= 0 || component != Reachability::invalid)
+				return false;
+			continue;
+		}
+
+		if (toIndex[expected[tile]] == Reachability::invalid)
+		{
+			if (!toFlood.emplace(component, expected[tile]).second)
+				return false;
+			toIndex[expected[tile]] = component;
+		}
+		else if (toIndex[expected[tile]] != component)
+			return false;
+	}
+
+	return static_cast<uint32_t>(componentCount) == reachability.getComponentCount();
+}
+} // namespace
+
+int main()
+{
+	JobSystem::Init();
+	std::mt19937 rng(5);
+	const auto randomTile = [&rng] { return glm::ivec2(static_cast<int>(rng() % mapSize), static_cast<int>(rng() % mapSize)); };
+
+	TileMap map;
+	map.create(mapSize, mapSize, Terrain::Grass);
+	for (int i = 0; i < 3000; i++)
+		map.setFlag(randomTile(), TileFlag::Wall, true);
+	map.clearDirty();
+
+	Reachability reachability;
+	reachability.create(map);
+	int failures = matches(map, reachability) ? 0 : 1;
+
+	// single walls toggled, wall segments built and segments torn down, a few per round so edits in one update
+	// can both split and join components
+	for (int round = 0; round < editRounds; round++)
+	{
+		const int edits = 1 + static_cast<int>(rng() % 6);
+		for (int edit = 0; edit < edits; edit++)
+		{
+			const glm::ivec2 tile = randomTile();
+			switch (rng() % 3)
+			{
+			case 0:
+				map.setFlag(tile, TileFlag::Wall, !map.hasFlag(tile, TileFlag::Wall));
+				break;
+			case 1:
+				for (int i = 0; i < 20; i++)
+				{
+					if (map.isInBounds({ tile.x + i, tile.y }))
+						map.setFlag({ tile.x + i, tile.y }, TileFlag::Wall, true);
+				}
+				break;
+			default:
+				for (int i = 0; i < 20; i++)
+				{
+					if (map.isInBounds({ tile.x, tile.y + i }))
+						map.setFlag({ tile.x, tile.y + i }, TileFlag::Wall, false);
+				}
+				break;
+			}
+		}
+
+		reachability.update(map.getDirtyChunks());
+		map.clearDirty();
+
+		if (!matches(map, reachability) && failures++ < 5)
+			std::printf("reachability differs from the flood fill after round %d\n", round);
+	}
+
+	JobSystem::Shutdown();
+
+	std::printf("%d of %d rounds differ, %u components\n", failures, editRounds + 1, reachability.getComponentCount());
+	return failures == 0 ? 0 : 1;
+}
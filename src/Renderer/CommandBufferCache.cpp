@@ -0,0 +1,110 @@
+#include "CommandBufferCache.h"
+
+void CommandBufferCache::create(vk::Device device, uint32_t queueFamilyIndex)
+{
+	m_device = device;
+
+	vk::CommandPoolCreateInfo createInfo;
+	createInfo.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+	createInfo.setQueueFamilyIndex(queueFamilyIndex);
+
+	m_commandPool = m_device.createCommandPool(createInfo);
+}
+
+void CommandBufferCache::destroy()
+{
+	m_entries.clear();
+	m_device.destroyCommandPool(m_commandPool);
+}
+
+void CommandBufferCache::clear()
+{
+	for (std::vector<Entry>& layerEntries : m_entries)
+	{
+		for (Entry& entry : layerEntries)
+		{
+			if (entry.buffer)
+				m_device.freeCommandBuffers(m_commandPool, 1, &entry.buffer);
+		}
+	}
+	m_entries.clear();
+}
+
+std::optional<vk::CommandBuffer> CommandBufferCache::find(uint32_t layer, uint32_t imageIndex, const CommandCacheKey& key) const
+{
+	const Entry* entry = findEntry(layer, imageIndex);
+	if (entry == nullptr || !entry->recorded || entry->key != key)
+		return std::nullopt;
+
+	return entry->buffer;
+}
+
+std::optional<uint64_t> CommandBufferCache::getLastUse(uint32_t layer, uint32_t imageIndex) const
+{
+	const Entry* entry = findEntry(layer, imageIndex);
+	return entry != nullptr ? entry->lastUse : std::nullopt;
+}
+
+vk::CommandBuffer CommandBufferCache::record(uint32_t layer,
+											 uint32_t imageIndex,
+											 const CommandCacheKey& key,
+											 const vk::CommandBufferInheritanceInfo& inheritance,
+											 const RecordFunc& recordFunc)
+{
+	Entry& entry = getEntry(layer, imageIndex);
+
+	if (!entry.buffer)
+	{
+		vk::CommandBufferAllocateInfo allocInfo;
+		allocInfo.setCommandPool(m_commandPool);
+		allocInfo.setLevel(vk::CommandBufferLevel::eSecondary);
+		allocInfo.setCommandBufferCount(1);
+
+		entry.buffer = m_device.allocateCommandBuffers(allocInfo)[0];
+	}
+	else
+	{
+		entry.buffer.reset();
+	}
+
+	// no one time submit, the buffer is replayed for as long as the key stays the same. a swapchain image can be
+	// acquired again while the primary that last executed the buffer is still pending, which a secondary without
+	// simultaneous use must not be recorded into another primary for
+	vk::CommandBufferBeginInfo beginInfo;
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eSimultaneousUse);
+	beginInfo.setPInheritanceInfo(&inheritance);
+
+	entry.buffer.begin(beginInfo);
+	recordFunc(entry.buffer);
+	entry.buffer.end();
+
+	entry.key = key;
+	entry.recorded = true;
+	m_recordCount++;
+
+	return entry.buffer;
+}
+
+void CommandBufferCache::markUsed(uint32_t layer, uint32_t imageIndex, uint64_t frameNumber)
+{
+	getEntry(layer, imageIndex).lastUse = frameNumber;
+}
+
+const CommandBufferCache::Entry* CommandBufferCache::findEntry(uint32_t layer, uint32_t imageIndex) const
+{
+	if (layer >= m_entries.size() || imageIndex >= m_entries[layer].size())
+		return nullptr;
+
+	return &m_entries[layer][imageIndex];
+}
+
+CommandBufferCache::Entry& CommandBufferCache::getEntry(uint32_t layer, uint32_t imageIndex)
+{
+	if (layer >= m_entries.size())
+		m_entries.resize(layer + 1);
+
+	if (imageIndex >= m_entries[layer].size())
+		m_entries[layer].resize(imageIndex + 1);
+
+	return m_entries[layer][imageIndex];
+}
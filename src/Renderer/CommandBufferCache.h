@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+// everything the recorded commands of a cached layer depend on, a mismatch means the buffer has to be re-recorded
+struct CommandCacheKey
+{
+	uint64_t generation = 0;
+	// the default pipeline, and the ones the items bring themselves folded into a hash, 0 if there are none
+	vk::Pipeline pipeline;
+	uint64_t itemPipelines = 0;
+	vk::Framebuffer framebuffer;
+	vk::Extent2D extent;
+
+	bool operator==(const CommandCacheKey& other) const = default;
+};
+
+// secondary command buffers recorded once per (layer, swapchain image) and replayed every frame until their key changes
+class CommandBufferCache
+{
+public:
+	using RecordFunc = std::function<void(vk::CommandBuffer cmd)>;
+
+	void create(vk::Device device, uint32_t queueFamilyIndex);
+	void destroy();
+
+	// forgets every recorded buffer, the device must be idle (e.g. after the swapchain was recreated)
+	void clear();
+
+	// returns the cached buffer if it was recorded with the same key
+	std::optional<vk::CommandBuffer> find(uint32_t layer, uint32_t imageIndex, const CommandCacheKey& key) const;
+	// frame number that last submitted this entry, it must have retired before the entry is re-recorded
+	std::optional<uint64_t> getLastUse(uint32_t layer, uint32_t imageIndex) const;
+
+	vk::CommandBuffer record(uint32_t layer,
+							 uint32_t imageIndex,
+							 const CommandCacheKey& key,
+							 const vk::CommandBufferInheritanceInfo& inheritance,
+							 const RecordFunc& recordFunc);
+	void markUsed(uint32_t layer, uint32_t imageIndex, uint64_t frameNumber);
+
+	uint64_t getRecordCount() const { return m_recordCount; }
+
+private:
+	struct Entry
+	{
+		vk::CommandBuffer buffer;
+		CommandCacheKey key;
+		bool recorded = false;
+		std::optional<uint64_t> lastUse;
+	};
+
+	const Entry* findEntry(uint32_t layer, uint32_t imageIndex) const;
+	Entry& getEntry(uint32_t layer, uint32_t imageIndex);
+
+private:
+	vk::Device m_device;
+	vk::CommandPool m_commandPool;
+
+	// indexed [layer][image]
+	std::vector<std::vector<Entry>> m_entries;
+	uint64_t m_recordCount = 0;
+};
@@ -0,0 +1,168 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <fstream>
+
+#include "Utils/Logging.hpp"
+
+namespace
+{
+constexpr std::array<const char*, static_cast<size_t>(FrameStat::Count)> statNames = { "cpu_frame", "sim_tick", "fence_wait" };
+
+constexpr uint32_t maxSampleUs = (1u << FrameTimeHistogram::maxValueBits) - 1;
+
+double toMs(uint32_t us)
+{
+	return static_cast<double>(us) / 1000.0;
+}
+} // namespace
+
+void FrameTimeHistogram::clear()
+{
+	m_buckets.fill(0);
+	m_count = 0;
+}
+
+uint32_t FrameTimeHistogram::getPercentile(double percentile) const
+{
+	if (m_count == 0)
+		return 0;
+
+	// rank of the sample at this percentile, 1 based
+	const uint32_t rank = std::max(1u, static_cast<uint32_t>(std::ceil(percentile * m_count)));
+
+	uint32_t seen = 0;
+	for (uint32_t bucket = 0; bucket < bucketCount; bucket++)
+	{
+		seen += m_buckets[bucket];
+		if (seen >= rank)
+			return getBucketUpperBound(bucket);
+	}
+	return getBucketUpperBound(bucketCount - 1);
+}
+
+uint32_t FrameTimeHistogram::getBucket(uint32_t us)
+{
+	us = std::min(us, maxSampleUs);
+
+	// below two octaves every value has its own bucket
+	if (us < 2 * subBucketCount)
+		return us;
+
+	const uint32_t shift = static_cast<uint32_t>(std::bit_width(us)) - 1 - subBucketBits;
+	return (shift + 1) * subBucketCount + (us >> shift) - subBucketCount;
+}
+
+uint32_t FrameTimeHistogram::getBucketUpperBound(uint32_t bucket)
+{
+	if (bucket < 2 * subBucketCount)
+		return bucket;
+
+	const uint32_t shift = bucket / subBucketCount - 1;
+	return (((bucket % subBucketCount + subBucketCount) + 1) << shift) - 1;
+}
+
+void FrameStats::create(std::span<const uint32_t> windows)
+{
+	m_windows.assign(windows.begin(), windows.end());
+	std::erase(m_windows, 0u);
+
+	m_capacity = m_windows.empty() ? 0 : *std::max_element(m_windows.begin(), m_windows.end());
+
+	for (Series& series : m_series)
+	{
+		series.samples.assign(m_capacity, 0);
+		series.written = 0;
+		series.histograms.assign(m_windows.size(), FrameTimeHistogram());
+	}
+}
+
+void FrameStats::record(FrameStat stat, double ms)
+{
+	if (m_capacity == 0)
+		return;
+
+	Series& series = m_series[static_cast<size_t>(stat)];
+	const uint32_t us = static_cast<uint32_t>(std::clamp(ms * 1000.0, 0.0, static_cast<double>(maxSampleUs)));
+
+	for (size_t i = 0; i < m_windows.size(); i++)
+	{
+		// the sample that falls out of this window is still in the ring, it holds the largest window
+		if (series.written >= m_windows[i])
+			series.histograms[i].remove(series.samples[(series.written - m_windows[i]) % m_capacity]);
+		series.histograms[i].add(us);
+	}
+
+	series.samples[series.written % m_capacity] = us;
+	series.written++;
+}
+
+FrameStatSummary FrameStats::getSummary(FrameStat stat, uint32_t window) const
+{
+	const Series& series = m_series[static_cast<size_t>(stat)];
+	const FrameTimeHistogram& histogram = series.histograms[window];
+
+	FrameStatSummary summary;
+	summary.sampleCount = histogram.getCount();
+	if (summary.sampleCount == 0)
+		return summary;
+
+	// the max is exact, the histogram only knows which bucket it is in
+	uint32_t maxUs = 0;
+	for (uint64_t i = series.written - summary.sampleCount; i < series.written; i++)
+		maxUs = std::max(maxUs, series.samples[i % m_capacity]);
+
+	// percentiles report bucket upper bounds, which can't be more than the largest sample
+	summary.p50Ms = toMs(std::min(histogram.getPercentile(0.50), maxUs));
+	summary.p95Ms = toMs(std::min(histogram.getPercentile(0.95), maxUs));
+	summary.p99Ms = toMs(std::min(histogram.getPercentile(0.99), maxUs));
+	summary.maxMs = toMs(maxUs);
+	return summary;
+}
+
+void FrameStats::logSummary() const
+{
+	for (uint32_t window = 0; window < getWindowCount(); window++)
+	{
+		for (size_t stat = 0; stat < static_cast<size_t>(FrameStat::Count); stat++)
+		{
+			const FrameStatSummary summary = getSummary(static_cast<FrameStat>(stat), window);
+			if (summary.sampleCount == 0)
+				continue;
+
+			LOG_INFO(LogCategory::Render, "{} (last {} frames): p50 {:.3f}ms, p95 {:.3f}ms, p99 {:.3f}ms, max {:.3f}ms",
+					 statNames[stat], summary.sampleCount, summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+		}
+	}
+}
+
+bool FrameStats::exportCsv(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR(LogCategory::Render, "failed to open frame stats output: {}", path);
+		return false;
+	}
+
+	file << "stat,window_frames,samples,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (uint32_t window = 0; window < getWindowCount(); window++)
+	{
+		for (size_t stat = 0; stat < static_cast<size_t>(FrameStat::Count); stat++)
+		{
+			const FrameStatSummary summary = getSummary(static_cast<FrameStat>(stat), window);
+			file << std::format("{},{},{},{:.4f},{:.4f},{:.4f},{:.4f}\n", statNames[stat], m_windows[window], summary.sampleCount,
+								summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+		}
+	}
+
+	return true;
+}
+
+const char* FrameStats::getName(FrameStat stat)
+{
+	return statNames[static_cast<size_t>(stat)];
+}
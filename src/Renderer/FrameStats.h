@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class FrameStat : uint8_t
+{
+	// time between the starts of consecutive frames
+	CpuFrame,
+	// time spent running simulation ticks in a frame
+	SimTick,
+	FenceWait,
+	Count
+};
+
+struct FrameStatSummary
+{
+	double p50Ms = 0.0;
+	double p95Ms = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
+	uint32_t sampleCount = 0;
+};
+
+// log-linear histogram of microsecond samples, 32 buckets per power of two keeps every bucket within ~3% of its value
+class FrameTimeHistogram
+{
+public:
+	static constexpr uint32_t subBucketBits = 5;
+	static constexpr uint32_t subBucketCount = 1u << subBucketBits;
+	// samples above ~16.7s land in the last bucket
+	static constexpr uint32_t maxValueBits = 24;
+	static constexpr uint32_t bucketCount = (maxValueBits - subBucketBits + 1) * subBucketCount;
+
+	void add(uint32_t us) { m_buckets[getBucket(us)]++; m_count++; }
+	void remove(uint32_t us) { m_buckets[getBucket(us)]--; m_count--; }
+	void clear();
+
+	uint32_t getCount() const { return m_count; }
+	// upper bound of the bucket holding the sample at percentile (0-1)
+	uint32_t getPercentile(double percentile) const;
+
+	static uint32_t getBucket(uint32_t us);
+	static uint32_t getBucketUpperBound(uint32_t bucket);
+
+private:
+	std::array<uint32_t, bucketCount> m_buckets = {};
+	uint32_t m_count = 0;
+};
+
+// rolling frame time percentiles. every window keeps its own histogram, samples leaving a window are
+// subtracted again, so recording never allocates and queries never sort
+class FrameStats
+{
+public:
+	// window lengths in frames
+	void create(std::span<const uint32_t> windows);
+	void create() { create(std::array<uint32_t, 2> { 120, 1200 }); }
+
+	// one sample per stat per frame
+	void record(FrameStat stat, double ms);
+
+	uint32_t getWindowCount() const { return static_cast<uint32_t>(m_windows.size()); }
+	uint32_t getWindowFrames(uint32_t window) const { return m_windows[window]; }
+
+	FrameStatSummary getSummary(FrameStat stat, uint32_t window) const;
+
+	void logSummary() const;
+	bool exportCsv(const std::string& path) const;
+
+	static const char* getName(FrameStat stat);
+
+private:
+	struct Series
+	{
+		// the last m_capacity samples in microseconds
+		std::vector<uint32_t> samples;
+		uint64_t written = 0;
+		std::vector<FrameTimeHistogram> histograms;
+	};
+
+	std::vector<uint32_t> m_windows;
+	uint32_t m_capacity = 0;
+	std::array<Series, static_cast<size_t>(FrameStat::Count)> m_series;
+};
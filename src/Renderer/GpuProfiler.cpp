@@ -0,0 +1,425 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include "Utils/Logging.hpp"
+
+namespace
+{
+constexpr std::array<const char*, static_cast<size_t>(CpuStage::Count)> cpuStageNames = {
+	"fence_wait", "acquire", "record", "submit", "present"
+};
+
+constexpr uint32_t noScope = UINT32_MAX;
+
+const vk::QueryPipelineStatisticFlags statisticFlags = vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+													   vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+													   vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+													   vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+													   vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+
+// scope names in order of first appearance, used as csv columns
+std::vector<const char*> collectScopeNames(const std::vector<FrameProfile>& history)
+{
+	std::vector<const char*> names;
+	for (const FrameProfile& profile : history)
+	{
+		for (uint32_t i = 0; i < profile.scopeCount; i++)
+		{
+			const char* name = profile.scopes[i].name;
+			bool found = false;
+			for (const char* existing : names)
+				found = found || strcmp(existing, name) == 0;
+
+			if (!found)
+				names.push_back(name);
+		}
+	}
+	return names;
+}
+
+double findScopeMs(const FrameProfile& profile, const char* name)
+{
+	for (uint32_t i = 0; i < profile.scopeCount; i++)
+	{
+		if (strcmp(profile.scopes[i].name, name) == 0)
+			return profile.scopes[i].gpuMs;
+	}
+	return 0.0;
+}
+} // namespace
+
+double FrameProfile::getCpuTotalMs() const
+{
+	double total = 0.0;
+	for (double ms : cpuMs)
+		total += ms;
+	return total;
+}
+
+void GpuProfiler::create(VulkanDevice& device, uint32_t framesInFlight, uint32_t historySize)
+{
+	m_device = device.handle;
+	m_enabled = device.getTimestampValidBits() > 0;
+	m_statisticsEnabled = m_enabled && device.supportsPipelineStatistics();
+	m_timestampPeriod = device.getTimestampPeriod();
+
+	const uint32_t validBits = device.getTimestampValidBits();
+	m_timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+	m_historySize = historySize;
+	m_history.reserve(historySize);
+
+	m_frames.resize(framesInFlight);
+	for (FrameQueries& frame : m_frames)
+	{
+		frame.openScopes.reserve(FrameProfile::maxScopes);
+
+		if (m_enabled)
+		{
+			vk::QueryPoolCreateInfo createInfo;
+			createInfo.setQueryType(vk::QueryType::eTimestamp);
+			createInfo.setQueryCount(m_timestampCount);
+			frame.timestamps = m_device.createQueryPool(createInfo);
+		}
+
+		if (m_statisticsEnabled)
+		{
+			vk::QueryPoolCreateInfo createInfo;
+			createInfo.setQueryType(vk::QueryType::ePipelineStatistics);
+			createInfo.setQueryCount(1);
+			createInfo.setPipelineStatistics(statisticFlags);
+			frame.statistics = m_device.createQueryPool(createInfo);
+		}
+	}
+
+	if (!m_enabled)
+		LOG_WARNING(LogCategory::Render, "graphics queue does not support timestamps, gpu profiling disabled");
+}
+
+void GpuProfiler::destroy()
+{
+	for (FrameQueries& frame : m_frames)
+	{
+		m_device.destroyQueryPool(frame.timestamps);
+		m_device.destroyQueryPool(frame.statistics);
+	}
+	m_frames.clear();
+}
+
+void GpuProfiler::collect(uint32_t frameIndex)
+{
+	FrameQueries& frame = m_frames[frameIndex];
+
+	if (frame.submitted)
+	{
+		FrameProfile profile = frame.pending;
+		bool available = true;
+
+		if (m_enabled)
+		{
+			std::array<uint64_t, m_timestampCount> timestamps = {};
+			const uint32_t count = 2 + 2 * frame.scopeCount;
+
+			// no wait flag, the frame's fence has already signaled so this only fails for queries that were never written
+			vk::Result result = m_device.getQueryPoolResults(frame.timestamps, 0, count, sizeof(uint64_t) * count, timestamps.data(),
+															 sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+			available = result == vk::Result::eSuccess;
+
+			if (available)
+			{
+				profile.gpuFrameMs = ticksToMs(timestamps[0], timestamps[1]);
+				profile.scopeCount = frame.scopeCount;
+				for (uint32_t i = 0; i < frame.scopeCount; i++)
+				{
+					profile.scopes[i].name = frame.scopeNames[i];
+					profile.scopes[i].gpuMs = ticksToMs(timestamps[2 + 2 * i], timestamps[3 + 2 * i]);
+				}
+			}
+		}
+
+		if (available && m_statisticsEnabled && frame.statisticsWritten)
+		{
+			std::array<uint64_t, 5> statistics = {};
+			vk::Result result = m_device.getQueryPoolResults(frame.statistics, 0, 1, sizeof(statistics), statistics.data(),
+															 sizeof(statistics), vk::QueryResultFlagBits::e64);
+
+			// results are written in the order of the flag bits
+			if (result == vk::Result::eSuccess)
+			{
+				profile.statistics.inputVertices = statistics[0];
+				profile.statistics.inputPrimitives = statistics[1];
+				profile.statistics.vertexInvocations = statistics[2];
+				profile.statistics.clippingPrimitives = statistics[3];
+				profile.statistics.fragmentInvocations = statistics[4];
+			}
+		}
+
+		if (available)
+			pushHistory(profile);
+	}
+
+	frame.submitted = false;
+	frame.pending = FrameProfile {};
+}
+
+void GpuProfiler::setCpuTime(uint32_t frameIndex, CpuStage stage, double ms)
+{
+	m_frames[frameIndex].pending.cpuMs[static_cast<size_t>(stage)] = ms;
+}
+
+void GpuProfiler::beginFrame(vk::CommandBuffer cmd, uint32_t frameIndex)
+{
+	FrameQueries& frame = m_frames[frameIndex];
+	m_recording = &frame;
+
+	frame.scopeCount = 0;
+	frame.openScopes.clear();
+	frame.statisticsWritten = false;
+	frame.submitted = true;
+	frame.pending.frameNumber = m_frameNumber++;
+
+	if (m_enabled)
+	{
+		cmd.resetQueryPool(frame.timestamps, 0, m_timestampCount);
+		cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.timestamps, 0);
+	}
+
+	if (m_statisticsEnabled)
+		cmd.resetQueryPool(frame.statistics, 0, 1);
+}
+
+void GpuProfiler::endFrame(vk::CommandBuffer cmd)
+{
+	if (m_recording == nullptr)
+		return;
+
+	while (!m_recording->openScopes.empty())
+		endScope(cmd);
+
+	if (m_enabled)
+		cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_recording->timestamps, 1);
+
+	m_recording = nullptr;
+}
+
+void GpuProfiler::beginStatistics(vk::CommandBuffer cmd)
+{
+	if (m_recording == nullptr || !m_statisticsEnabled)
+		return;
+
+	cmd.beginQuery(m_recording->statistics, 0, vk::QueryControlFlags());
+}
+
+void GpuProfiler::endStatistics(vk::CommandBuffer cmd)
+{
+	if (m_recording == nullptr || !m_statisticsEnabled)
+		return;
+
+	cmd.endQuery(m_recording->statistics, 0);
+	m_recording->statisticsWritten = true;
+}
+
+vk::QueryPipelineStatisticFlags GpuProfiler::getInheritedStatistics() const
+{
+	return m_statisticsEnabled ? statisticFlags : vk::QueryPipelineStatisticFlags();
+}
+
+void GpuProfiler::beginScope(vk::CommandBuffer cmd, const char* name)
+{
+	if (m_recording == nullptr)
+		return;
+
+	// still push so the matching endScope stays balanced
+	if (!m_enabled || m_recording->scopeCount >= FrameProfile::maxScopes)
+	{
+		m_recording->openScopes.push_back(noScope);
+		return;
+	}
+
+	const uint32_t scope = m_recording->scopeCount++;
+	m_recording->scopeNames[scope] = name;
+	m_recording->openScopes.push_back(scope);
+
+	cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_recording->timestamps, 2 + 2 * scope);
+}
+
+void GpuProfiler::endScope(vk::CommandBuffer cmd)
+{
+	if (m_recording == nullptr || m_recording->openScopes.empty())
+		return;
+
+	const uint32_t scope = m_recording->openScopes.back();
+	m_recording->openScopes.pop_back();
+
+	if (scope != noScope)
+		cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_recording->timestamps, 3 + 2 * scope);
+}
+
+std::vector<FrameProfile> GpuProfiler::getHistory() const
+{
+	if (m_history.size() < m_historySize)
+		return m_history;
+
+	std::vector<FrameProfile> ordered;
+	ordered.reserve(m_history.size());
+	ordered.insert(ordered.end(), m_history.begin() + m_historyNext, m_history.end());
+	ordered.insert(ordered.end(), m_history.begin(), m_history.begin() + m_historyNext);
+	return ordered;
+}
+
+FrameProfile GpuProfiler::getAverage(uint32_t frameCount) const
+{
+	const std::vector<FrameProfile> history = getHistory();
+	FrameProfile average;
+
+	if (history.empty())
+		return average;
+
+	const size_t count = frameCount == 0 ? history.size() : std::min<size_t>(frameCount, history.size());
+	const size_t first = history.size() - count;
+
+	for (size_t i = first; i < history.size(); i++)
+	{
+		const FrameProfile& profile = history[i];
+		for (size_t stage = 0; stage < average.cpuMs.size(); stage++)
+			average.cpuMs[stage] += profile.cpuMs[stage];
+
+		average.gpuFrameMs += profile.gpuFrameMs;
+		average.statistics.inputVertices += profile.statistics.inputVertices;
+		average.statistics.inputPrimitives += profile.statistics.inputPrimitives;
+		average.statistics.vertexInvocations += profile.statistics.vertexInvocations;
+		average.statistics.clippingPrimitives += profile.statistics.clippingPrimitives;
+		average.statistics.fragmentInvocations += profile.statistics.fragmentInvocations;
+
+		for (uint32_t scope = 0; scope < profile.scopeCount; scope++)
+		{
+			uint32_t slot = 0;
+			while (slot < average.scopeCount && strcmp(average.scopes[slot].name, profile.scopes[scope].name) != 0)
+				slot++;
+
+			if (slot == average.scopeCount)
+			{
+				if (slot >= FrameProfile::maxScopes)
+					continue;
+				average.scopes[slot].name = profile.scopes[scope].name;
+				average.scopeCount++;
+			}
+			average.scopes[slot].gpuMs += profile.scopes[scope].gpuMs;
+		}
+	}
+
+	for (double& ms : average.cpuMs)
+		ms /= count;
+
+	average.frameNumber = history.back().frameNumber;
+	average.gpuFrameMs /= count;
+	average.statistics.inputVertices /= count;
+	average.statistics.inputPrimitives /= count;
+	average.statistics.vertexInvocations /= count;
+	average.statistics.clippingPrimitives /= count;
+	average.statistics.fragmentInvocations /= count;
+
+	for (uint32_t scope = 0; scope < average.scopeCount; scope++)
+		average.scopes[scope].gpuMs /= count;
+
+	return average;
+}
+
+bool GpuProfiler::exportCsv(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR(LogCategory::Render, "failed to open profile output: {}", path);
+		return false;
+	}
+
+	const std::vector<FrameProfile> history = getHistory();
+	const std::vector<const char*> scopeNames = collectScopeNames(history);
+
+	file << "frame,cpu_total_ms";
+	for (const char* stage : cpuStageNames)
+		file << ',' << stage << "_ms";
+	file << ",gpu_frame_ms";
+	for (const char* scope : scopeNames)
+		file << ",gpu_" << scope << "_ms";
+	file << ",input_vertices,input_primitives,vertex_invocations,clipping_primitives,fragment_invocations\n";
+
+	for (const FrameProfile& profile : history)
+	{
+		file << std::format("{},{:.4f}", profile.frameNumber, profile.getCpuTotalMs());
+		for (double ms : profile.cpuMs)
+			file << std::format(",{:.4f}", ms);
+		file << std::format(",{:.4f}", profile.gpuFrameMs);
+		for (const char* scope : scopeNames)
+			file << std::format(",{:.4f}", findScopeMs(profile, scope));
+
+		const PipelineStatistics& stats = profile.statistics;
+		file << std::format(",{},{},{},{},{}\n", stats.inputVertices, stats.inputPrimitives, stats.vertexInvocations,
+							stats.clippingPrimitives, stats.fragmentInvocations);
+	}
+
+	return true;
+}
+
+bool GpuProfiler::exportJson(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR(LogCategory::Render, "failed to open profile output: {}", path);
+		return false;
+	}
+
+	const std::vector<FrameProfile> history = getHistory();
+
+	file << "{\n\t\"frames\": [";
+	for (size_t i = 0; i < history.size(); i++)
+	{
+		const FrameProfile& profile = history[i];
+		file << (i == 0 ? "\n" : ",\n");
+		file << std::format("\t\t{{ \"frame\": {}, \"cpu\": {{ \"total_ms\": {:.4f}", profile.frameNumber, profile.getCpuTotalMs());
+		for (size_t stage = 0; stage < cpuStageNames.size(); stage++)
+			file << std::format(", \"{}_ms\": {:.4f}", cpuStageNames[stage], profile.cpuMs[stage]);
+
+		file << std::format(" }}, \"gpu\": {{ \"frame_ms\": {:.4f}, \"scopes\": {{", profile.gpuFrameMs);
+		for (uint32_t scope = 0; scope < profile.scopeCount; scope++)
+		{
+			file << std::format("{} \"{}\": {:.4f}", scope == 0 ? "" : ",", profile.scopes[scope].name, profile.scopes[scope].gpuMs);
+		}
+
+		const PipelineStatistics& stats = profile.statistics;
+		file << std::format(" }} }}, \"statistics\": {{ \"input_vertices\": {}, \"input_primitives\": {}, \"vertex_invocations\": {}, "
+							"\"clipping_primitives\": {}, \"fragment_invocations\": {} }} }}",
+							stats.inputVertices, stats.inputPrimitives, stats.vertexInvocations, stats.clippingPrimitives,
+							stats.fragmentInvocations);
+	}
+	file << "\n\t]\n}\n";
+
+	return true;
+}
+
+void GpuProfiler::pushHistory(const FrameProfile& profile)
+{
+	if (m_historySize == 0)
+		return;
+
+	if (m_history.size() < m_historySize)
+	{
+		m_history.push_back(profile);
+		return;
+	}
+
+	m_history[m_historyNext] = profile;
+	m_historyNext = (m_historyNext + 1) % m_historySize;
+}
+
+double GpuProfiler::ticksToMs(uint64_t begin, uint64_t end) const
+{
+	const uint64_t ticks = (end - begin) & m_timestampMask;
+	return static_cast<double>(ticks) * m_timestampPeriod / 1e6;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "Vulkan/Core/Device.h"
+
+// cpu side stages of Renderer::drawFrame
+enum class CpuStage : uint8_t
+{
+	FenceWait,
+	Acquire,
+	Record,
+	Submit,
+	Present,
+	Count
+};
+
+struct GpuScopeTiming
+{
+	const char* name = nullptr;
+	double gpuMs = 0.0;
+};
+
+struct PipelineStatistics
+{
+	uint64_t inputVertices = 0;
+	uint64_t inputPrimitives = 0;
+	uint64_t vertexInvocations = 0;
+	uint64_t clippingPrimitives = 0;
+	uint64_t fragmentInvocations = 0;
+};
+
+struct FrameProfile
+{
+	static constexpr uint32_t maxScopes = 32;
+
+	uint64_t frameNumber = 0;
+	std::array<double, static_cast<size_t>(CpuStage::Count)> cpuMs = {};
+	double gpuFrameMs = 0.0;
+
+	std::array<GpuScopeTiming, maxScopes> scopes = {};
+	uint32_t scopeCount = 0;
+
+	PipelineStatistics statistics;
+
+	double getCpuTotalMs() const;
+};
+
+// per frame in flight timestamp and pipeline statistics queries, results are only read back once
+// the frame's fence has signaled so collecting never stalls the cpu
+class GpuProfiler
+{
+public:
+	void create(VulkanDevice& device, uint32_t framesInFlight, uint32_t historySize = 600);
+	void destroy();
+
+	// call after the fence for frameIndex has been waited on, reads back the results of the last use of this slot
+	void collect(uint32_t frameIndex);
+
+	void setCpuTime(uint32_t frameIndex, CpuStage stage, double ms);
+
+	// recorded into the frame's primary command buffer, outside of any render pass
+	void beginFrame(vk::CommandBuffer cmd, uint32_t frameIndex);
+	void endFrame(vk::CommandBuffer cmd);
+
+	// wraps the whole render pass from the primary buffer, secondary buffers inherit the query
+	void beginStatistics(vk::CommandBuffer cmd);
+	void endStatistics(vk::CommandBuffer cmd);
+
+	// statistics flags secondary command buffers have to declare in their inheritance info
+	vk::QueryPipelineStatisticFlags getInheritedStatistics() const;
+
+	// name must outlive the profiler, string literals are expected
+	void beginScope(vk::CommandBuffer cmd, const char* name);
+	void endScope(vk::CommandBuffer cmd);
+
+	// false when the graphics queue has no timestamp support, cpu timings are still collected
+	bool isEnabled() const { return m_enabled; }
+
+	// collected frames, oldest first
+	std::vector<FrameProfile> getHistory() const;
+	// average over the last frameCount collected frames, 0 means the whole history
+	FrameProfile getAverage(uint32_t frameCount = 0) const;
+
+	bool exportCsv(const std::string& path) const;
+	bool exportJson(const std::string& path) const;
+
+private:
+	struct FrameQueries
+	{
+		vk::QueryPool timestamps;
+		vk::QueryPool statistics;
+
+		std::array<const char*, FrameProfile::maxScopes> scopeNames = {};
+		uint32_t scopeCount = 0;
+		std::vector<uint32_t> openScopes;
+
+		bool statisticsWritten = false;
+		bool submitted = false;
+
+		FrameProfile pending;
+	};
+
+	void pushHistory(const FrameProfile& profile);
+
+	double ticksToMs(uint64_t begin, uint64_t end) const;
+
+private:
+	// timestamp 0/1 bracket the frame, scope i uses 2 + 2i and 3 + 2i
+	static constexpr uint32_t m_timestampCount = 2 + 2 * FrameProfile::maxScopes;
+
+	vk::Device m_device;
+	bool m_enabled = false;
+	bool m_statisticsEnabled = false;
+	uint64_t m_timestampMask = 0;
+	double m_timestampPeriod = 1.0;
+
+	std::vector<FrameQueries> m_frames;
+	FrameQueries* m_recording = nullptr;
+	uint64_t m_frameNumber = 0;
+
+	std::vector<FrameProfile> m_history;
+	uint32_t m_historySize = 0;
+	uint32_t m_historyNext = 0;
+};
+
+// records a named gpu scope for the lifetime of the object
+class GpuScope
+{
+public:
+	GpuScope(GpuProfiler& profiler, vk::CommandBuffer cmd, const char* name)
+		: m_profiler(profiler), m_cmd(cmd)
+	{
+		m_profiler.beginScope(m_cmd, name);
+	}
+
+	~GpuScope() { m_profiler.endScope(m_cmd); }
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+	GpuProfiler& m_profiler;
+	vk::CommandBuffer m_cmd;
+};
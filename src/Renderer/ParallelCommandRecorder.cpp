@@ -0,0 +1,125 @@
+#include "ParallelCommandRecorder.h"
+
+#include <algorithm>
+
+#include "Utils/JobSystem.hpp"
+#include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
+
+void ParallelCommandRecorder::create(vk::Device device, uint32_t queueFamilyIndex, uint32_t framesInFlight)
+{
+	m_device = device;
+
+	const uint32_t workerCount = std::max(1u, JobSystem::GetWorkerCount());
+
+	m_pools.resize(workerCount);
+	for (std::vector<FramePool>& workerPools : m_pools)
+	{
+		workerPools.resize(framesInFlight);
+		for (FramePool& framePool : workerPools)
+		{
+			vk::CommandPoolCreateInfo createInfo;
+			createInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+			createInfo.setQueueFamilyIndex(queueFamilyIndex);
+			framePool.pool = m_device.createCommandPool(createInfo);
+		}
+	}
+
+	LOG_INFO(LogCategory::Render, "command recording on {} workers", workerCount);
+}
+
+void ParallelCommandRecorder::destroy()
+{
+	// destroying the pool frees every buffer allocated from it
+	for (std::vector<FramePool>& workerPools : m_pools)
+	{
+		for (FramePool& framePool : workerPools)
+			m_device.destroyCommandPool(framePool.pool);
+	}
+	m_pools.clear();
+}
+
+void ParallelCommandRecorder::reset(uint32_t frameIndex)
+{
+	// nothing records between calls to record, so the pools can be reset from the calling thread
+	for (std::vector<FramePool>& workerPools : m_pools)
+	{
+		FramePool& framePool = workerPools[frameIndex];
+		m_device.resetCommandPool(framePool.pool);
+		framePool.used = 0;
+	}
+}
+
+const std::vector<vk::CommandBuffer>& ParallelCommandRecorder::record(uint32_t frameIndex,
+																	  const vk::CommandBufferInheritanceInfo& inheritance,
+																	  uint32_t itemCount,
+																	  const RecordSliceFunc& recordSlice)
+{
+	m_output.clear();
+
+	if (itemCount == 0)
+		return m_output;
+
+	const uint32_t minSlice = std::max(1u, minItemsPerSlice);
+	const uint32_t sliceCount = std::min(getThreadCount(), (itemCount + minSlice - 1) / minSlice);
+	const uint32_t sliceSize = itemCount / sliceCount;
+	const uint32_t remainder = itemCount % sliceCount;
+
+	m_slices.resize(sliceCount);
+	uint32_t first = 0;
+	for (uint32_t i = 0; i < sliceCount; i++)
+	{
+		m_slices[i].first = first;
+		m_slices[i].count = sliceSize + (i < remainder ? 1 : 0);
+		first += m_slices[i].count;
+	}
+
+	m_frameIndex = frameIndex;
+	m_inheritance = &inheritance;
+	m_recordSlice = &recordSlice;
+
+	// one slice per job, the calling thread records the first and helps with the rest while it waits
+	JobSystem::ParallelFor(sliceCount, 1, [this](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+			this->recordSlice(m_slices[i]);
+	});
+
+	for (const Slice& slice : m_slices)
+		m_output.push_back(slice.buffer);
+
+	return m_output;
+}
+
+void ParallelCommandRecorder::recordSlice(Slice& slice)
+{
+	TRACE_ZONE("ParallelCommandRecorder::recordSlice");
+
+	// slices only run on job workers, or inline on the calling thread before the job system is up
+	const uint32_t workerIndex = JobSystem::GetWorkerIndex();
+	slice.buffer = acquireBuffer(workerIndex == JobSystem::InvalidWorker ? 0 : workerIndex);
+
+	vk::CommandBufferBeginInfo beginInfo;
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+	beginInfo.setPInheritanceInfo(m_inheritance);
+
+	slice.buffer.begin(beginInfo);
+	(*m_recordSlice)(slice.buffer, slice.first, slice.count);
+	slice.buffer.end();
+}
+
+vk::CommandBuffer ParallelCommandRecorder::acquireBuffer(uint32_t workerIndex)
+{
+	FramePool& framePool = m_pools[workerIndex][m_frameIndex];
+
+	if (framePool.used == framePool.buffers.size())
+	{
+		vk::CommandBufferAllocateInfo allocInfo;
+		allocInfo.setCommandPool(framePool.pool);
+		allocInfo.setLevel(vk::CommandBufferLevel::eSecondary);
+		allocInfo.setCommandBufferCount(1);
+
+		framePool.buffers.push_back(m_device.allocateCommandBuffers(allocInfo)[0]);
+	}
+
+	return framePool.buffers[framePool.used++];
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+// records a draw list into secondary command buffers on the job system, every job worker owns a command pool
+// per frame in flight so recording never shares a pool between threads
+class ParallelCommandRecorder
+{
+public:
+	using RecordSliceFunc = std::function<void(vk::CommandBuffer cmd, uint32_t first, uint32_t count)>;
+
+	// JobSystem must be initialised first, one pool set is created per worker
+	void create(vk::Device device, uint32_t queueFamilyIndex, uint32_t framesInFlight);
+	void destroy();
+
+	// resets every worker's pool for frameIndex, must only be called once the previous submission of frameIndex
+	// has finished executing
+	void reset(uint32_t frameIndex);
+
+	// splits itemCount items into contiguous slices and records each into its own secondary buffer, the returned
+	// buffers are in slice order, they stay valid until frameIndex is reset but the vector is reused by the next call
+	const std::vector<vk::CommandBuffer>& record(uint32_t frameIndex,
+												 const vk::CommandBufferInheritanceInfo& inheritance,
+												 uint32_t itemCount,
+												 const RecordSliceFunc& recordSlice);
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(m_pools.size()); }
+
+	// slices smaller than this are not worth handing to another worker
+	uint32_t minItemsPerSlice = 64;
+
+private:
+	struct FramePool
+	{
+		vk::CommandPool pool;
+		std::vector<vk::CommandBuffer> buffers;
+		uint32_t used = 0;
+	};
+
+	struct Slice
+	{
+		uint32_t first = 0;
+		uint32_t count = 0;
+		vk::CommandBuffer buffer;
+	};
+
+	void recordSlice(Slice& slice);
+	vk::CommandBuffer acquireBuffer(uint32_t workerIndex);
+
+private:
+	vk::Device m_device;
+
+	// indexed [worker][frame], by JobSystem::GetWorkerIndex
+	std::vector<std::vector<FramePool>> m_pools;
+
+	// state of the frame currently being recorded, only written while no slice is being recorded
+	uint32_t m_frameIndex = 0;
+	const vk::CommandBufferInheritanceInfo* m_inheritance = nullptr;
+	const RecordSliceFunc* m_recordSlice = nullptr;
+	std::vector<Slice> m_slices;
+
+	std::vector<vk::CommandBuffer> m_output;
+};
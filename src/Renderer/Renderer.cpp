@@ -1,5 +1,6 @@
 #include "Renderer.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -29,9 +30,40 @@ const std::vector<Vertex> vertices = { { { -0.5f, -0.5f }, { 1.0f, 0.0f, 1.0f }
 									   { { 0.5f, 0.5f }, { 0.0f, 1.0f, 1.0f } },
 									   { { -0.5f, 0.5f }, { 1.0f, 0.0f, 1.0f } } };
 const std::vector<uint16_t> indices = { 0, 1, 2, 2, 3, 0 };
+
+// room for ~400k sprite instances per frame
+const vk::DeviceSize frameRingSize = 8 * 1024 * 1024;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// the pipelines the items bind instead of the default one, in draw order
+uint64_t hashItemPipelines(const std::vector<DrawItem>& items)
+{
+	uint64_t hash = 0;
+	for (const DrawItem& item : items)
+	{
+		if (item.pipeline)
+			hash = (hash ^ std::hash<vk::Pipeline> {}(item.pipeline)) * 1099511628211ull;
+	}
+	return hash;
+}
 } // namespace
 
-const uint32_t Renderer::m_framesInFlight = 2;
+uint32_t Renderer::m_framesInFlight = 2;
+
+void Renderer::setFramesInFlight(uint32_t count)
+{
+	const uint32_t clamped = std::clamp(count, 1u, maxFramesInFlight);
+	if (clamped != count)
+		LOG_WARNING(LogCategory::Render, "{} frames in flight not supported, using {}", count, clamped);
+
+	m_framesInFlight = clamped;
+}
 
 Renderer::Renderer()
 {
@@ -49,7 +81,83 @@ void Renderer::initVulkan(Window* window)
 
 	createCommandObjects();
 	createSyncObjects();
+	createResources();
 
+	m_pipeline.create(m_device, m_swapchain, "vert.spv", "frag.spv", m_pipelineDescriptor.getLayout());
+	m_spritePipeline.setVertexInput(SpriteBatch::getVertexInput());
+	m_spritePipeline.create(m_device, m_swapchain, "sprite_vert.spv", "sprite_frag.spv", m_pipelineDescriptor.getLayout());
+	m_swapchain.createFramebuffers(m_pipeline.getRenderPass());
+
+	// m_texture.create(m_device, "test.png");
+	// transitionImageLayout(m_texture.handle, vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eUndefined,
+	// vk::ImageLayout::eTransferDstOptimal); copyBufferToImage(m_texture.getStagingBufferHandle(), m_texture.handle, m_texture.getWidth(),
+	// m_texture.getHeight()); transitionImageLayout(m_texture.handle, vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eTransferDstOptimal,
+	//					  vk::ImageLayout::eShaderReadOnlyOptimal);
+	// m_texture.freeStagingBuffer();
+	// m_sampler.create(m_device);
+	LOG_INFO(LogCategory::Render, "pass");
+}
+
+void Renderer::initHeadless(vk::Extent2D extent)
+{
+	m_headless = true;
+
+	m_instance.create(true);
+	m_device.create(m_instance.handle, nullptr);
+	m_offscreenTarget.create(m_device, extent, vk::Format::eR8G8B8A8Unorm, m_framesInFlight);
+
+	createCommandObjects();
+	createSyncObjects();
+	createResources();
+
+	m_pipeline.create(m_device, m_offscreenTarget.getFormat(), extent, vk::ImageLayout::eTransferSrcOptimal, "vert.spv", "frag.spv",
+					  m_pipelineDescriptor.getLayout());
+	m_spritePipeline.setVertexInput(SpriteBatch::getVertexInput());
+	m_spritePipeline.create(m_device, m_offscreenTarget.getFormat(), extent, vk::ImageLayout::eTransferSrcOptimal,
+							"sprite_vert.spv", "sprite_frag.spv", m_pipelineDescriptor.getLayout());
+	m_offscreenTarget.createFramebuffers(m_pipeline.getRenderPass());
+	if (m_readbackEnabled)
+		m_offscreenTarget.createReadbackBuffers();
+
+	LOG_INFO(LogCategory::Render, "headless renderer created ({}x{})", extent.width, extent.height);
+}
+
+void Renderer::cleanup()
+{
+	m_device.handle.waitIdle();
+
+	m_commandCache.destroy();
+	m_recorder.destroy();
+	m_spriteBatch.destroy();
+	m_frameRing.destroy();
+	m_uploads.destroy();
+	m_profiler.destroy();
+	m_indexBuffer.destroy();
+	m_vertexBuffer.destroy();
+
+	m_spritePipeline.destroy();
+	m_pipeline.destroy();
+	m_pipelineDescriptor.destroy();
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		m_device.handle.destroySemaphore(m_imgAvailableSemaphores[i]);
+		m_device.handle.destroySemaphore(m_renderFinishedSemaphores[i]);
+	}
+	m_frameTimeline.destroy();
+	m_device.handle.destroyCommandPool(m_commandPool);
+
+	if (m_headless)
+		m_offscreenTarget.destroy();
+	else
+		m_swapchain.destroy();
+
+	// also writes the pipeline cache back to disk
+	m_device.destroy();
+}
+
+void Renderer::createResources()
+{
 	/*for (int i = 0; i < m_framesInFlight; i++)
 	{
 		VulkanUniformBuffer buffer;
@@ -57,22 +165,47 @@ void Renderer::initVulkan(Window* window)
 		m_uniformBuffers.emplace_back(std::move(buffer));
 	}*/
 
-	m_vertexBuffer.create(m_device, vertices);
-	m_indexBuffer.create(m_device, indices);
+	m_uploads.create(m_device);
+	m_vertexBuffer.create(m_device, vertices, m_uploads);
+	m_indexBuffer.create(m_device, indices, m_uploads);
 
 	m_pipelineDescriptor.create(m_device.handle, m_framesInFlight, m_uniformBuffers);
 
-	m_pipeline.create(m_device.handle, m_swapchain, "vert.spv", "frag.spv", m_pipelineDescriptor.getLayout());
-	m_swapchain.createFramebuffers(m_pipeline.getRenderPass());
+	m_profiler.create(m_device, m_framesInFlight);
+	m_frameStats.create();
 
-	// m_texture.create(m_device, "test.png");
-	// transitionImageLayout(m_texture.handle, vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eUndefined,
-	// vk::ImageLayout::eTransferDstOptimal); copyBufferToImage(m_texture.getStagingBufferHandle(), m_texture.handle, m_texture.getWidth(),
-	// m_texture.getHeight()); transitionImageLayout(m_texture.handle, vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eTransferDstOptimal,
-	//					  vk::ImageLayout::eShaderReadOnlyOptimal);
-	// m_texture.freeStagingBuffer();
-	// m_sampler.create(m_device);
-	Logging::Info("pass");
+	vulkan_utils::QueueFamilyIndices queueFamilies =
+		vulkan_utils::findQueueFamilies(m_device.getPhysicalDevice(), m_swapchain.getSurface());
+	m_recorder.create(m_device.handle, queueFamilies.graphicsFamily.value(), m_framesInFlight);
+	m_commandCache.create(m_device.handle, queueFamilies.graphicsFamily.value());
+
+	m_frameRing.create(m_device, frameRingSize * m_framesInFlight, m_framesInFlight,
+					   vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer |
+						   vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer);
+	m_spriteBatch.create(m_device, m_uploads, m_framesInFlight, { 0.02f, 0.02f });
+
+	DrawItem quad;
+	quad.vertexBuffer = m_vertexBuffer.handle;
+	quad.indexBuffer = m_indexBuffer.handle;
+	quad.count = static_cast<uint32_t>(indices.size());
+
+	setLayerDrawItems(RenderLayer::Terrain, { quad });
+}
+
+void Renderer::setLayerDrawItems(RenderLayer layer, std::vector<DrawItem> items)
+{
+	LayerDrawList& drawList = m_layers[static_cast<size_t>(layer)];
+	drawList.items = std::move(items);
+	drawList.itemPipelines = hashItemPipelines(drawList.items);
+	drawList.generation++;
+}
+
+void Renderer::markLayerDirty(RenderLayer layer)
+{
+	// the items may have been edited in place
+	LayerDrawList& drawList = m_layers[static_cast<size_t>(layer)];
+	drawList.itemPipelines = hashItemPipelines(drawList.items);
+	drawList.generation++;
 }
 
 void Renderer::createCommandObjects()
@@ -101,18 +234,20 @@ void Renderer::createSyncObjects()
 {
 	m_imgAvailableSemaphores.resize(m_framesInFlight);
 	m_renderFinishedSemaphores.resize(m_framesInFlight);
-	m_inFlightFences.resize(m_framesInFlight);
+	m_slotFrames.assign(m_framesInFlight, 0);
 
-	for (int i = 0; i < m_framesInFlight; i++)
+	// headless frames never acquire or present
+	if (!m_headless)
 	{
-		vk::SemaphoreCreateInfo semaphoreCreateInfo;
-		m_imgAvailableSemaphores[i] = m_device.handle.createSemaphore(semaphoreCreateInfo);
-		m_renderFinishedSemaphores[i] = m_device.handle.createSemaphore(semaphoreCreateInfo);
-
-		vk::FenceCreateInfo fenceCreateInfo;
-		fenceCreateInfo.setFlags(vk::FenceCreateFlagBits::eSignaled);
-		m_inFlightFences[i] = m_device.handle.createFence(fenceCreateInfo);
+		for (int i = 0; i < m_framesInFlight; i++)
+		{
+			vk::SemaphoreCreateInfo semaphoreCreateInfo;
+			m_imgAvailableSemaphores[i] = m_device.handle.createSemaphore(semaphoreCreateInfo);
+			m_renderFinishedSemaphores[i] = m_device.handle.createSemaphore(semaphoreCreateInfo);
+		}
 	}
+
+	m_frameTimeline.create(m_device.handle);
 }
 
 vk::CommandBuffer Renderer::beginSingleTimeCommands()
@@ -140,30 +275,109 @@ void Renderer::endSingleTimeCommands(vk::CommandBuffer cmd)
 	submitInfo.setCommandBufferCount(1);
 	submitInfo.setPCommandBuffers(&cmd);
 
-	vk::Queue graphicsQueue = m_device.getGraphicsQueue();
-	graphicsQueue.submit(1, &submitInfo, nullptr);
-	graphicsQueue.waitIdle();
+	// only wait for this submission, not everything else that is queued
+	vk::Fence fence = m_device.handle.createFence(vk::FenceCreateInfo());
+	(void) m_device.getGraphicsQueue().submit(1, &submitInfo, fence);
+	(void) m_device.handle.waitForFences(1, &fence, true, UINT64_MAX);
 
+	m_device.handle.destroyFence(fence);
 	m_device.handle.freeCommandBuffers(m_commandPool, 1, &cmd);
 }
 
 
 void Renderer::recordCommandBuffer(vk::CommandBuffer cmdBuffer, uint32_t imgIndex)
 {
+	TRACE_ZONE("Renderer::recordCommandBuffer");
 	vk::CommandBufferBeginInfo info;
 	cmdBuffer.begin(info);
 
+	m_profiler.beginFrame(cmdBuffer, m_currentFrame);
+	m_profiler.beginStatistics(cmdBuffer);
+	m_profiler.beginScope(cmdBuffer, "render_pass");
+
 	vk::ClearValue clearColor = vk::ClearColorValue { 0.f, 0.f, 0.f, 1.f };
 
 	vk::RenderPassBeginInfo renderPassInfo;
 	renderPassInfo.setRenderPass(m_pipeline.getRenderPass());
-	renderPassInfo.setFramebuffer(m_swapchain.getFramebuffer(imgIndex));
+	renderPassInfo.setFramebuffer(getTargetFramebuffer(imgIndex));
 	renderPassInfo.renderArea.offset = vk::Offset2D { 0, 0 };
-	renderPassInfo.renderArea.extent = m_swapchain.getExtent();
+	renderPassInfo.renderArea.extent = getTargetExtent();
 	renderPassInfo.clearValueCount = 1;
 	renderPassInfo.pClearValues = &clearColor;
 
-	auto extent = m_swapchain.getExtent();
+	cmdBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+
+	vk::CommandBufferInheritanceInfo inheritance;
+	inheritance.setRenderPass(m_pipeline.getRenderPass());
+	inheritance.setSubpass(0);
+	inheritance.setFramebuffer(getTargetFramebuffer(imgIndex));
+	inheritance.setPipelineStatistics(m_profiler.getInheritedStatistics());
+
+	m_recorder.reset(m_currentFrame);
+	for (uint32_t layer = 0; layer < m_layers.size(); layer++)
+		recordLayer(cmdBuffer, layer, imgIndex, inheritance);
+
+	cmdBuffer.endRenderPass();
+
+	m_profiler.endScope(cmdBuffer);
+	m_profiler.endStatistics(cmdBuffer);
+
+	if (m_headless && m_readbackEnabled)
+	{
+		GpuScope scope(m_profiler, cmdBuffer, "readback");
+		m_offscreenTarget.recordReadback(cmdBuffer, imgIndex);
+	}
+
+	m_profiler.endFrame(cmdBuffer);
+	cmdBuffer.end();
+}
+
+void Renderer::recordLayer(vk::CommandBuffer cmdBuffer, uint32_t layer, uint32_t imgIndex, const vk::CommandBufferInheritanceInfo& inheritance)
+{
+	const LayerDrawList& drawList = m_layers[layer];
+	const uint32_t itemCount = static_cast<uint32_t>(drawList.items.size());
+
+	if (itemCount == 0)
+		return;
+
+	if (!isStaticLayer(static_cast<RenderLayer>(layer)))
+	{
+		const std::vector<vk::CommandBuffer>& secondaries =
+			m_recorder.record(m_currentFrame, inheritance, itemCount, [this, &drawList](vk::CommandBuffer cmd, uint32_t first, uint32_t count) {
+				recordDrawItems(cmd, drawList.items, first, count);
+			});
+
+		cmdBuffer.executeCommands(secondaries);
+		return;
+	}
+
+	CommandCacheKey key;
+	key.generation = drawList.generation;
+	key.pipeline = m_pipeline.handle;
+	key.itemPipelines = drawList.itemPipelines;
+	key.framebuffer = getTargetFramebuffer(imgIndex);
+	key.extent = getTargetExtent();
+
+	std::optional<vk::CommandBuffer> cached = m_commandCache.find(layer, imgIndex, key);
+	if (!cached.has_value())
+	{
+		// the frame that last replayed this buffer may still be executing
+		std::optional<uint64_t> lastUse = m_commandCache.getLastUse(layer, imgIndex);
+		if (lastUse.has_value() && lastUse.value() != m_frameTimeline.getCurrentFrame())
+			m_frameTimeline.wait(lastUse.value());
+
+		cached = m_commandCache.record(layer, imgIndex, key, inheritance,
+									   [this, &drawList, itemCount](vk::CommandBuffer cmd) { recordDrawItems(cmd, drawList.items, 0, itemCount); });
+	}
+
+	m_commandCache.markUsed(layer, imgIndex, m_frameTimeline.getCurrentFrame());
+	cmdBuffer.executeCommands(1, &cached.value());
+}
+
+void Renderer::recordDrawItems(vk::CommandBuffer cmdBuffer, const std::vector<DrawItem>& items, uint32_t first, uint32_t count)
+{
+	// secondary buffers inherit nothing but the render pass, so every slice sets up its own state
+	auto extent = getTargetExtent();
 	vk::Viewport viewport;
 	viewport.x = 0.f;
 	viewport.y = 0.f;
@@ -176,36 +390,112 @@ void Renderer::recordCommandBuffer(vk::CommandBuffer cmdBuffer, uint32_t imgInde
 	scissor.offset = vk::Offset2D { 0, 0 };
 	scissor.extent = extent;
 
-	std::array<vk::Buffer, 1> vertexBuffers = { m_vertexBuffer.handle };
-	std::array<vk::DeviceSize, 1> offsets = { 0 };
-
-	cmdBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-	cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipeline.handle);
 	cmdBuffer.setViewport(0, 1, &viewport);
 	cmdBuffer.setScissor(0, 1, &scissor);
-	cmdBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
-	cmdBuffer.bindIndexBuffer(m_indexBuffer.handle, 0, vk::IndexType::eUint16);
 	// cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline.getLayout(), 0, 1,
 	//								 &m_pipelineDescriptor.getDescriptorSet(m_currentFrame), 0, nullptr);
-	cmdBuffer.drawIndexed(indices.size(), 1, 0, 0, 0);
-	cmdBuffer.draw(3, 1, 0, 0);
 
-	cmdBuffer.endRenderPass();
-	cmdBuffer.end();
+	vk::Pipeline boundPipeline;
+	vk::Buffer boundVertexBuffer;
+	vk::Buffer boundIndexBuffer;
+	vk::Buffer boundInstanceBuffer;
+	vk::DeviceSize boundInstanceOffset = 0;
+
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		const DrawItem& item = items[i];
+
+		const vk::Pipeline pipeline = item.pipeline ? item.pipeline : m_pipeline.handle;
+		if (pipeline != boundPipeline)
+		{
+			cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+			boundPipeline = pipeline;
+		}
+
+		if (item.vertexBuffer != boundVertexBuffer)
+		{
+			std::array<vk::Buffer, 1> vertexBuffers = { item.vertexBuffer };
+			std::array<vk::DeviceSize, 1> offsets = { 0 };
+			cmdBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
+			boundVertexBuffer = item.vertexBuffer;
+		}
+
+		if (item.instanceBuffer && (item.instanceBuffer != boundInstanceBuffer || item.instanceOffset != boundInstanceOffset))
+		{
+			std::array<vk::Buffer, 1> instanceBuffers = { item.instanceBuffer };
+			std::array<vk::DeviceSize, 1> offsets = { item.instanceOffset };
+			cmdBuffer.bindVertexBuffers(1, instanceBuffers, offsets);
+			boundInstanceBuffer = item.instanceBuffer;
+			boundInstanceOffset = item.instanceOffset;
+		}
+
+		if (!item.indexBuffer)
+		{
+			cmdBuffer.draw(item.count, item.instanceCount, item.first, item.firstInstance);
+			continue;
+		}
+
+		if (item.indexBuffer != boundIndexBuffer)
+		{
+			cmdBuffer.bindIndexBuffer(item.indexBuffer, 0, item.indexType);
+			boundIndexBuffer = item.indexBuffer;
+		}
+
+		cmdBuffer.drawIndexed(item.count, item.instanceCount, item.first, item.vertexOffset, item.firstInstance);
+	}
+}
+
+void Renderer::onSwapchainRecreated()
+{
+	// recreate waits for the device to go idle, so nothing cached can still be executing. framebuffer handles may be
+	// reused by the new swapchain, so the extent/framebuffer key alone is not enough to catch this
+	m_commandCache.clear();
+}
+
+vk::Framebuffer Renderer::getTargetFramebuffer(uint32_t imgIndex) const
+{
+	return m_headless ? m_offscreenTarget.getFramebuffer(imgIndex) : m_swapchain.getFramebuffer(imgIndex);
+}
+
+vk::Extent2D Renderer::getTargetExtent() const
+{
+	return m_headless ? m_offscreenTarget.getExtent() : m_swapchain.getExtent();
 }
 
 void Renderer::drawFrame()
 {
+	TRACE_ZONE("Renderer::drawFrame");
+
+	const Clock::time_point frameStart = Clock::now();
+	if (m_lastFrameStart != Clock::time_point())
+		m_frameStats.record(FrameStat::CpuFrame, std::chrono::duration<double, std::milli>(frameStart - m_lastFrameStart).count());
+	m_lastFrameStart = frameStart;
+
+	if (m_headless)
+	{
+		drawFrameHeadless();
+		return;
+	}
+
 	VulkanSwapchain& swapchain = m_swapchain;
 
-	(void) m_device.handle.waitForFences(1, &m_inFlightFences[m_currentFrame], true, UINT64_MAX);
+	auto stageStart = Clock::now();
+	m_frameTimeline.wait(m_slotFrames[m_currentFrame]);
+	m_profiler.collect(m_currentFrame);
+	m_frameRing.beginFrame(m_currentFrame);
+	const double fenceWaitMs = elapsedMs(stageStart);
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::FenceWait, fenceWaitMs);
+	m_frameStats.record(FrameStat::FenceWait, fenceWaitMs);
 
+	stageStart = Clock::now();
 	auto nextImgResult = m_device.handle.acquireNextImageKHR(swapchain.handle, UINT64_MAX, m_imgAvailableSemaphores[m_currentFrame]);
 	uint32_t imgIndex = nextImgResult.value;
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::Acquire, elapsedMs(stageStart));
 
 	if (nextImgResult.result == vk::Result::eErrorOutOfDateKHR)
 	{
 		swapchain.recreate(m_window->getGLFWWindow());
+		onSwapchainRecreated();
 		return;
 	}
 	else if (nextImgResult.result != vk::Result::eSuccess && nextImgResult.result != vk::Result::eSuboptimalKHR)
@@ -213,37 +503,35 @@ void Renderer::drawFrame()
 		throw std::runtime_error("failed to acquire swapchain img");
 	}
 
-	(void) m_device.handle.resetFences(1, &m_inFlightFences[m_currentFrame]);
-
+	stageStart = Clock::now();
 	updateUniformBuffer();
 
+	updateSpriteBatch();
+
 	m_commandBuffers[m_currentFrame].reset();
 	recordCommandBuffer(m_commandBuffers[m_currentFrame], imgIndex);
+	m_frameRing.flush();
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::Record, elapsedMs(stageStart));
 
-	std::array<vk::Semaphore, 1> waitSemaphores = { m_imgAvailableSemaphores[m_currentFrame] };
-	std::array<vk::Semaphore, 1> signalSemaphores = { m_renderFinishedSemaphores[m_currentFrame] };
-	std::array<vk::PipelineStageFlags, 1> waitStages = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
-	std::array<vk::CommandBuffer, 1> cmdBuffers = { m_commandBuffers[m_currentFrame] };
-	vk::SubmitInfo submitInfo;
-	submitInfo.setWaitSemaphores(waitSemaphores);
-	submitInfo.setSignalSemaphores(signalSemaphores);
-	submitInfo.setWaitDstStageMask(waitStages);
-	submitInfo.setCommandBuffers(cmdBuffers);
-
-	(void) m_device.getGraphicsQueue().submit(1, &submitInfo, m_inFlightFences[m_currentFrame]);
+	stageStart = Clock::now();
+	submitFrame(m_imgAvailableSemaphores[m_currentFrame], m_renderFinishedSemaphores[m_currentFrame]);
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::Submit, elapsedMs(stageStart));
 
+	stageStart = Clock::now();
 	vk::PresentInfoKHR presentInfo;
-	presentInfo.setWaitSemaphores(signalSemaphores);
+	presentInfo.setWaitSemaphores(m_renderFinishedSemaphores[m_currentFrame]);
 	presentInfo.swapchainCount = 1;
 	presentInfo.pSwapchains = &swapchain.handle;
 	presentInfo.pImageIndices = &imgIndex;
 
 	vk::Result result = m_device.getPresentQueue().presentKHR(presentInfo);
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::Present, elapsedMs(stageStart));
 
 	if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR || m_window->hasResized())
 	{
 		m_window->setResized(false);
 		swapchain.recreate(m_window->getGLFWWindow());
+		onSwapchainRecreated();
 	}
 	else if (result != vk::Result::eSuccess)
 	{
@@ -253,6 +541,110 @@ void Renderer::drawFrame()
 	m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
 }
 
+void Renderer::drawFrameHeadless()
+{
+	// each frame in flight owns the offscreen image with the same index, so no acquire/present is needed
+	auto stageStart = Clock::now();
+	m_frameTimeline.wait(m_slotFrames[m_currentFrame]);
+	m_profiler.collect(m_currentFrame);
+	m_frameRing.beginFrame(m_currentFrame);
+	const double fenceWaitMs = elapsedMs(stageStart);
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::FenceWait, fenceWaitMs);
+	m_frameStats.record(FrameStat::FenceWait, fenceWaitMs);
+
+	stageStart = Clock::now();
+	updateUniformBuffer();
+
+	updateSpriteBatch();
+
+	m_commandBuffers[m_currentFrame].reset();
+	recordCommandBuffer(m_commandBuffers[m_currentFrame], m_currentFrame);
+	m_frameRing.flush();
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::Record, elapsedMs(stageStart));
+
+	stageStart = Clock::now();
+	submitFrame(nullptr, nullptr);
+	m_profiler.setCpuTime(m_currentFrame, CpuStage::Submit, elapsedMs(stageStart));
+
+	m_lastSubmittedFrame = m_currentFrame;
+	m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+}
+
+void Renderer::submitFrame(vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore)
+{
+	// anything queued this frame goes out first, the gpu then holds vertex input until the copies have landed
+	m_uploads.submit();
+
+	std::vector<vk::Semaphore> waitSemaphores = { m_uploads.getSemaphore() };
+	std::vector<uint64_t> waitValues = { m_uploads.getSubmittedValue() };
+	std::vector<vk::PipelineStageFlags> waitStages = { vk::PipelineStageFlagBits::eVertexInput };
+
+	if (waitSemaphore)
+	{
+		waitSemaphores.push_back(waitSemaphore);
+		// binary semaphores ignore their value
+		waitValues.push_back(0);
+		waitStages.push_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+	}
+
+	// the frame signals its number on the timeline, plus the binary semaphore present waits on
+	std::vector<vk::Semaphore> signalSemaphores = { m_frameTimeline.getSemaphore() };
+	std::vector<uint64_t> signalValues = { m_frameTimeline.getCurrentFrame() };
+	if (signalSemaphore)
+	{
+		signalSemaphores.push_back(signalSemaphore);
+		signalValues.push_back(0);
+	}
+
+	vk::TimelineSemaphoreSubmitInfo timelineInfo;
+	timelineInfo.setWaitSemaphoreValues(waitValues);
+	timelineInfo.setSignalSemaphoreValues(signalValues);
+
+	std::array<vk::CommandBuffer, 1> cmdBuffers = { m_commandBuffers[m_currentFrame] };
+	vk::SubmitInfo submitInfo;
+	submitInfo.setPNext(&timelineInfo);
+	submitInfo.setWaitSemaphores(waitSemaphores);
+	submitInfo.setWaitDstStageMask(waitStages);
+	submitInfo.setCommandBuffers(cmdBuffers);
+	submitInfo.setSignalSemaphores(signalSemaphores);
+
+	(void) m_device.getGraphicsQueue().submit(1, &submitInfo, nullptr);
+
+	m_slotFrames[m_currentFrame] = m_frameTimeline.getCurrentFrame();
+	m_frameTimeline.advance();
+}
+
+void Renderer::setReadbackEnabled(bool enabled)
+{
+	m_readbackEnabled = enabled;
+
+	// before initHeadless the buffers are created along with the images
+	if (enabled && m_headless)
+		m_offscreenTarget.createReadbackBuffers();
+}
+
+bool Renderer::readbackLastFrame(std::vector<uint8_t>& pixels)
+{
+	if (!m_headless || !m_readbackEnabled || !m_lastSubmittedFrame.has_value())
+		return false;
+
+	const uint32_t frame = m_lastSubmittedFrame.value();
+	m_frameTimeline.wait(m_slotFrames[frame]);
+
+	return m_offscreenTarget.readback(frame, pixels);
+}
+
+void Renderer::updateSpriteBatch()
+{
+	// the entities layer is dynamic, so its draw list is rebuilt from the batch every frame
+	m_spriteBatch.upload(m_currentFrame, m_frameRing);
+
+	LayerDrawList& drawList = m_layers[static_cast<size_t>(RenderLayer::Entities)];
+	drawList.items.clear();
+	m_spriteBatch.appendDrawItems(m_currentFrame, m_spritePipeline.handle, drawList.items);
+	drawList.generation++;
+}
+
 void Renderer::updateUniformBuffer()
 {
 	/*	static auto startTime = std::chrono::high_resolution_clock::now();
@@ -312,7 +704,7 @@ void Renderer::transitionImageLayout(vk::Image img, vk::Format format, vk::Image
 	}
 	else
 	{
-		Logging::Warning("unsupported layout transition");
+		LOG_WARNING(LogCategory::Render, "unsupported layout transition");
 	}
 
 	cmd.pipelineBarrier(srcStage, dstStage, vk::DependencyFlagBits(0), 0, nullptr, 0, nullptr, 1, &barrier);
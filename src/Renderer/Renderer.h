@@ -1,13 +1,27 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <cstdint>
-
+#include <optional>
+#include <vector>
+
+#include "Renderer/CommandBufferCache.h"
+#include "Renderer/FrameStats.h"
+#include "Renderer/GpuProfiler.h"
+#include "Renderer/ParallelCommandRecorder.h"
+#include "Renderer/SpriteBatch.h"
+#include "Renderer/Types/DrawItem.h"
+#include "Vulkan/Core/FrameTimeline.h"
 #include "Vulkan/Core/Instance.h"
+#include "Vulkan/Core/OffscreenTarget.h"
 #include "Vulkan/Core/Window.h"
 // #include "Vulkan/Core/image/Sampler.h"
 // #include "Vulkan/Core/image/Texture.h"
 #include "Vulkan/Memory/IndexBuffer.h"
+#include "Vulkan/Memory/RingBuffer.h"
 #include "Vulkan/Memory/UniformBuffer.h"
+#include "Vulkan/Memory/UploadManager.h"
 #include "Vulkan/Pipeline/GraphicsPipeline.h"
 #include "Vulkan/Memory/VertexBuffer.h"
 #include "Vulkan/Pipeline/PipelineDescriptor.h"
@@ -19,12 +33,21 @@ public:
 	Renderer();
 
 	void initVulkan(Window* window);
+	// renders into offscreen images instead of a swapchain, no window or surface is created
+	void initHeadless(vk::Extent2D extent);
 	void cleanup();
 
 	vk::CommandBuffer beginSingleTimeCommands();
 	void endSingleTimeCommands(vk::CommandBuffer cmd);
 
 	void recordCommandBuffer(vk::CommandBuffer cmdBuffer, uint32_t imgIndex);
+	// records items[first, first + count) into a secondary buffer inside the main render pass
+	void recordDrawItems(vk::CommandBuffer cmdBuffer, const std::vector<DrawItem>& items, uint32_t first, uint32_t count);
+
+	// replaces the contents of a layer, static layers are re-recorded on the next frame
+	void setLayerDrawItems(RenderLayer layer, std::vector<DrawItem> items);
+	// forces a static layer to be re-recorded, e.g. after the buffers it references were updated in place
+	void markLayerDirty(RenderLayer layer);
 
 	void transitionImageLayout(vk::Image img, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout);
 	void copyBufferToImage(vk::Buffer buffer, vk::Image image, uint32_t width, uint32_t height);
@@ -32,37 +55,97 @@ public:
 	void drawFrame();
 	void waitIdle();
 
+	bool isHeadless() const { return m_headless; }
+	// headless only, copies every rendered frame into a host visible buffer. the buffers are created the first
+	// time it is enabled
+	void setReadbackEnabled(bool enabled);
+	// blocks until the most recently submitted headless frame has finished and copies out its rgba8 pixels
+	bool readbackLastFrame(std::vector<uint8_t>& pixels);
+
+	GpuProfiler& getProfiler() { return m_profiler; }
+	// rolling frame time percentiles, sim tick time is recorded by whoever runs the ticks
+	FrameStats& getFrameStats() { return m_frameStats; }
+	// queued copies are submitted with the next frame, which waits on them on the gpu before drawing
+	VulkanUploadManager& getUploadManager() { return m_uploads; }
+	// contents are uploaded and drawn on the entities layer every frame
+	SpriteBatch& getSpriteBatch() { return m_spriteBatch; }
+
+	// the timeline value of a frame is its frame number, use it to check if data a frame used can be reused
+	const FrameTimeline& getFrameTimeline() const { return m_frameTimeline; }
+	uint64_t getCurrentFrameNumber() const { return m_frameTimeline.getCurrentFrame(); }
+
+	static constexpr uint32_t maxFramesInFlight = 4;
+	// more frames in flight trade latency for throughput, must be set before the renderer is initialized
+	static void setFramesInFlight(uint32_t count);
 	static const uint32_t getFramesInFlight() { return m_framesInFlight; }
 
 private:
 	void createCommandObjects();
 	void createSyncObjects();
+	void createResources();
+
+	void drawFrameHeadless();
+	void submitFrame(vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore);
+	void recordLayer(vk::CommandBuffer cmdBuffer, uint32_t layer, uint32_t imgIndex, const vk::CommandBufferInheritanceInfo& inheritance);
+	void onSwapchainRecreated();
+
+	vk::Framebuffer getTargetFramebuffer(uint32_t imgIndex) const;
+	vk::Extent2D getTargetExtent() const;
 
 	void updateUniformBuffer();
+	void updateSpriteBatch();
 
 private:
 	VulkanInstance m_instance;
 	VulkanDevice m_device;
 	VulkanSwapchain m_swapchain;
+	VulkanOffscreenTarget m_offscreenTarget;
+	bool m_headless = false;
+	bool m_readbackEnabled = false;
 
 	PipelineDescriptor m_pipelineDescriptor;
 	VulkanGraphicsPipeline m_pipeline;
+	VulkanGraphicsPipeline m_spritePipeline;
 	Window* m_window = nullptr;
 
-	static const uint32_t m_framesInFlight;
+	static uint32_t m_framesInFlight;
+	// index of the frame in flight being recorded, selects the per frame resources
 	uint32_t m_currentFrame = 0;
+	std::optional<uint32_t> m_lastSubmittedFrame;
 
 	vk::CommandPool m_commandPool;
 	std::vector<vk::CommandBuffer> m_commandBuffers;
 
+	// acquire and present only take binary semaphores, everything else syncs on the frame timeline
 	std::vector<vk::Semaphore> m_imgAvailableSemaphores;
 	std::vector<vk::Semaphore> m_renderFinishedSemaphores;
-	std::vector<vk::Fence> m_inFlightFences;
+	FrameTimeline m_frameTimeline;
+	// frame number last submitted from each frame in flight
+	std::vector<uint64_t> m_slotFrames;
 
 	VulkanVertexBuffer m_vertexBuffer;
 	VulkanIndexBuffer m_indexBuffer;
 	std::vector<VulkanUniformBuffer> m_uniformBuffers;
 
+	VulkanUploadManager m_uploads;
+	// per frame dynamic data (instances, uniforms, debug geometry)
+	VulkanRingBuffer m_frameRing;
+	GpuProfiler m_profiler;
+	FrameStats m_frameStats;
+	std::chrono::steady_clock::time_point m_lastFrameStart;
+	SpriteBatch m_spriteBatch;
+	ParallelCommandRecorder m_recorder;
+	CommandBufferCache m_commandCache;
+
+	struct LayerDrawList
+	{
+		std::vector<DrawItem> items;
+		uint64_t generation = 0;
+		// see CommandCacheKey::itemPipelines
+		uint64_t itemPipelines = 0;
+	};
+	std::array<LayerDrawList, static_cast<size_t>(RenderLayer::Count)> m_layers;
+
 	//VulkanTexture m_texture;
 	//VulkanSampler m_sampler;
 };
\ No newline at end of file
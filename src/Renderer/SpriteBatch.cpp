@@ -0,0 +1,120 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Utils/Logging.hpp"
+
+void SpriteBatch::create(VulkanDevice& device, VulkanUploadManager& uploads, uint32_t framesInFlight, glm::vec2 spriteSize)
+{
+	m_device = &device;
+
+	const glm::vec2 half = spriteSize * 0.5f;
+	const std::vector<Vertex> vertices = { { { -half.x, -half.y }, { 1.0f, 1.0f, 1.0f } },
+										   { { half.x, -half.y }, { 1.0f, 1.0f, 1.0f } },
+										   { { half.x, half.y }, { 1.0f, 1.0f, 1.0f } },
+										   { { -half.x, half.y }, { 1.0f, 1.0f, 1.0f } } };
+	const std::vector<uint16_t> indices = { 0, 1, 2, 2, 3, 0 };
+
+	m_quadVertices.create(device, vertices, uploads);
+	m_quadIndices.create(device, indices, uploads);
+
+	m_uploads.resize(framesInFlight);
+}
+
+void SpriteBatch::destroy()
+{
+	m_uploads.clear();
+
+	m_quadIndices.destroy();
+	m_quadVertices.destroy();
+}
+
+void SpriteBatch::clear()
+{
+	for (std::vector<SpriteInstance>& layer : m_layers)
+		layer.clear();
+}
+
+void SpriteBatch::add(const SpriteInstance& instance)
+{
+#ifdef DEBUG
+	// sprites are re-added every frame, so a bad layer would flood the log
+	if (instance.layer >= maxLayers && !m_warnedLayer)
+	{
+		LOG_WARNING(LogCategory::Render, "sprite layer {} out of range, clamping it and any others", instance.layer);
+		m_warnedLayer = true;
+	}
+#endif
+	m_layers[std::min(instance.layer, maxLayers - 1)].push_back(instance);
+}
+
+uint32_t SpriteBatch::getInstanceCount() const
+{
+	size_t count = 0;
+	for (const std::vector<SpriteInstance>& layer : m_layers)
+		count += layer.size();
+	return static_cast<uint32_t>(count);
+}
+
+bool SpriteBatch::upload(uint32_t frameIndex, VulkanRingBuffer& ring)
+{
+	FrameUpload& upload = m_uploads[frameIndex];
+	upload = FrameUpload {};
+
+	const uint32_t count = getInstanceCount();
+	if (count == 0)
+		return true;
+
+	std::optional<RingAllocation> allocation = ring.allocate(sizeof(SpriteInstance) * count, alignof(SpriteInstance));
+	if (!allocation.has_value())
+	{
+		LOG_WARNING(LogCategory::Render, "frame ring buffer full, skipping {} sprites", count);
+		return false;
+	}
+
+	// layers are written back to back straight into mapped memory, which is what gives the draw order
+	auto* dst = static_cast<SpriteInstance*>(allocation->data);
+	for (const std::vector<SpriteInstance>& layer : m_layers)
+	{
+		memcpy(dst, layer.data(), sizeof(SpriteInstance) * layer.size());
+		dst += layer.size();
+	}
+
+	upload.buffer = allocation->buffer;
+	upload.offset = allocation->offset;
+	upload.count = count;
+	return true;
+}
+
+void SpriteBatch::appendDrawItems(uint32_t frameIndex, vk::Pipeline pipeline, std::vector<DrawItem>& items) const
+{
+	const FrameUpload& upload = m_uploads[frameIndex];
+
+	for (uint32_t first = 0; first < upload.count; first += maxInstancesPerDraw)
+	{
+		DrawItem item;
+		item.pipeline = pipeline;
+		item.vertexBuffer = m_quadVertices.handle;
+		item.indexBuffer = m_quadIndices.handle;
+		item.instanceBuffer = upload.buffer;
+		item.instanceOffset = upload.offset;
+		item.count = 6;
+		item.instanceCount = std::min(maxInstancesPerDraw, upload.count - first);
+		item.firstInstance = first;
+		items.push_back(item);
+	}
+}
+
+VertexInputDescription SpriteBatch::getVertexInput()
+{
+	VertexInputDescription description;
+	description.bindings = { Vertex::getBindingDescription(), SpriteInstance::getBindingDescription() };
+
+	for (const auto& attribute : Vertex::getAttributeDescription())
+		description.attributes.push_back(attribute);
+	for (const auto& attribute : SpriteInstance::getAttributeDescription())
+		description.attributes.push_back(attribute);
+
+	return description;
+}
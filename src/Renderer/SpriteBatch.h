@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Renderer/Types/DrawItem.h"
+#include "Renderer/Types/SpriteInstance.h"
+#include "Vulkan/Memory/IndexBuffer.h"
+#include "Vulkan/Memory/RingBuffer.h"
+#include "Vulkan/Memory/VertexBuffer.h"
+#include "Vulkan/Pipeline/GraphicsPipeline.h"
+
+// draws every sprite as an instance of one shared quad, instances are grouped by layer so the whole batch
+// is a handful of instanced draws no matter how many entities there are
+class SpriteBatch
+{
+public:
+	static constexpr uint32_t maxLayers = 16;
+	// large enough to keep the draw count low, small enough that the draws spread over the recording threads
+	static constexpr uint32_t maxInstancesPerDraw = 16384;
+
+	void create(VulkanDevice& device, VulkanUploadManager& uploads, uint32_t framesInFlight, glm::vec2 spriteSize);
+	void destroy();
+
+	// instances persist until cleared, so static sprites only need to be added once
+	void clear();
+	void add(const SpriteInstance& instance);
+	uint32_t getInstanceCount() const;
+
+	// copies the instances into the frame's ring buffer space, returns false if the ring is out of space
+	bool upload(uint32_t frameIndex, VulkanRingBuffer& ring);
+	void appendDrawItems(uint32_t frameIndex, vk::Pipeline pipeline, std::vector<DrawItem>& items) const;
+
+	static VertexInputDescription getVertexInput();
+
+private:
+	VulkanDevice* m_device = nullptr;
+
+	VulkanVertexBuffer m_quadVertices;
+	VulkanIndexBuffer m_quadIndices;
+
+	struct FrameUpload
+	{
+		vk::Buffer buffer;
+		vk::DeviceSize offset = 0;
+		uint32_t count = 0;
+	};
+	std::vector<FrameUpload> m_uploads;
+
+	std::array<std::vector<SpriteInstance>, maxLayers> m_layers;
+	// out of range layers are only reported once
+	bool m_warnedLayer = false;
+};
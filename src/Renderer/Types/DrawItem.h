@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+
+// one draw call in the renderer's draw list, indexed when indexBuffer is set
+struct DrawItem
+{
+	// null uses the renderer's default pipeline
+	vk::Pipeline pipeline;
+
+	vk::Buffer vertexBuffer;
+	// bound to binding 1 when set
+	vk::Buffer instanceBuffer;
+	vk::DeviceSize instanceOffset = 0;
+	vk::Buffer indexBuffer;
+	vk::IndexType indexType = vk::IndexType::eUint16;
+
+	// index count for indexed draws, vertex count otherwise
+	uint32_t count = 0;
+	uint32_t instanceCount = 1;
+	uint32_t first = 0;
+	int32_t vertexOffset = 0;
+	uint32_t firstInstance = 0;
+};
+
+// draw order of the renderer's layers, static layers are recorded once and replayed until their content changes
+enum class RenderLayer : uint8_t
+{
+	Terrain,
+	Entities,
+	Overlay,
+	UI,
+	Count
+};
+
+inline bool isStaticLayer(RenderLayer layer)
+{
+	return layer == RenderLayer::Terrain || layer == RenderLayer::UI;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+#include <glm/vec2.hpp>
+
+// per instance data of the sprite batch, streamed through vertex binding 1
+struct SpriteInstance
+{
+	glm::vec2 position;
+	uint32_t atlasIndex = 0;
+	// rgba8, red in the lowest byte
+	uint32_t tint = 0xffffffff;
+	// sprites are drawn in ascending layer order, SpriteBatch buckets by it so the shader never sees it
+	uint32_t layer = 0;
+
+	static vk::VertexInputBindingDescription getBindingDescription()
+	{
+		vk::VertexInputBindingDescription bindingDesc;
+		bindingDesc.setBinding(1);
+		bindingDesc.setStride(sizeof(SpriteInstance));
+		bindingDesc.setInputRate(vk::VertexInputRate::eInstance);
+		return bindingDesc;
+	};
+
+	// locations 0 and 1 are taken by Vertex
+	static std::array<vk::VertexInputAttributeDescription, 3> getAttributeDescription()
+	{
+		std::array<vk::VertexInputAttributeDescription, 3> descriptions;
+		descriptions[0].setBinding(1);
+		descriptions[0].setLocation(2);
+		descriptions[0].setFormat(vk::Format::eR32G32Sfloat);
+		descriptions[0].setOffset(offsetof(SpriteInstance, position));
+
+		descriptions[1].setBinding(1);
+		descriptions[1].setLocation(3);
+		descriptions[1].setFormat(vk::Format::eR32Uint);
+		descriptions[1].setOffset(offsetof(SpriteInstance, atlasIndex));
+
+		descriptions[2].setBinding(1);
+		descriptions[2].setLocation(4);
+		descriptions[2].setFormat(vk::Format::eR8G8B8A8Unorm);
+		descriptions[2].setOffset(offsetof(SpriteInstance, tint));
+		return descriptions;
+	}
+};
@@ -0,0 +1,119 @@
+#include "Archetype.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Utils/Logging.hpp"
+
+namespace
+{
+uint32_t alignUp(uint32_t value, uint32_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+} // namespace
+
+Archetype::Archetype(const ComponentMask& mask)
+	: m_mask(mask)
+{
+	// column 0 holds the entities
+	m_columns.push_back(Column { 0, sizeof(Entity), alignof(Entity), 0 });
+	for (ComponentId id = 0; id < maxComponents; id++)
+	{
+		if (!mask.test(id))
+			continue;
+
+		m_columnIndex[id] = static_cast<uint8_t>(m_columns.size());
+		const ComponentInfo& info = getComponentInfo(id);
+		m_columns.push_back(Column { id, info.size, info.alignment, 0 });
+	}
+
+	uint32_t rowSize = 0;
+	for (const Column& column : m_columns)
+		rowSize += column.size;
+
+	// start from the unpadded capacity and back off until the aligned columns fit
+	m_chunkCapacity = std::max(1u, static_cast<uint32_t>(chunkSize / rowSize));
+	for (;;)
+	{
+		uint32_t offset = 0;
+		for (Column& column : m_columns)
+		{
+			column.offset = alignUp(offset, column.alignment);
+			offset = column.offset + column.size * m_chunkCapacity;
+		}
+
+		if (offset <= chunkSize)
+			break;
+
+		if (m_chunkCapacity == 1)
+		{
+			LOG_ERROR(LogCategory::Sim, "archetype row of {} bytes doesn't fit in a {} byte chunk", offset, chunkSize);
+			throw std::runtime_error("archetype row too large");
+		}
+		m_chunkCapacity--;
+	}
+}
+
+uint32_t Archetype::getChunkRows(uint32_t chunk) const
+{
+	return std::min(m_chunkCapacity, m_count - chunk * m_chunkCapacity);
+}
+
+uint32_t Archetype::pushBack(Entity entity)
+{
+	const uint32_t row = m_count;
+	if (row / m_chunkCapacity == m_chunks.size())
+		m_chunks.push_back(std::make_unique<Chunk>());
+
+	m_count++;
+	memcpy(getRow(row, m_columns.front()), &entity, sizeof(Entity));
+	return row;
+}
+
+Entity Archetype::swapRemove(uint32_t row)
+{
+	const uint32_t last = m_count - 1;
+	Entity moved;
+
+	if (row != last)
+	{
+		for (const Column& column : m_columns)
+			memcpy(getRow(row, column), getRow(last, column), column.size);
+		moved = getEntity(row);
+	}
+
+	m_count--;
+
+	// keep one empty chunk around so an entity bouncing across a chunk boundary doesn't reallocate every time
+	while (m_chunks.size() > getChunkCount() + 1)
+		m_chunks.pop_back();
+
+	return moved;
+}
+
+void* Archetype::getComponent(uint32_t row, ComponentId id)
+{
+	return getRow(row, m_columns[m_columnIndex[id]]);
+}
+
+const void* Archetype::getComponent(uint32_t row, ComponentId id) const
+{
+	return getRow(row, m_columns[m_columnIndex[id]]);
+}
+
+const Entity* Archetype::getEntities(uint32_t chunk) const
+{
+	return reinterpret_cast<const Entity*>(m_chunks[chunk]->data + m_columns.front().offset);
+}
+
+void* Archetype::getColumn(uint32_t chunk, ComponentId id)
+{
+	return m_chunks[chunk]->data + m_columns[m_columnIndex[id]].offset;
+}
+
+std::byte* Archetype::getRow(uint32_t row, const Column& column) const
+{
+	return m_chunks[row / m_chunkCapacity]->data + column.offset + static_cast<size_t>(row % m_chunkCapacity) * column.size;
+}
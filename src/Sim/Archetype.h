@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Sim/Component.h"
+#include "Sim/Entity.h"
+
+// every entity with exactly the same set of components. rows are packed into fixed size chunks, each chunk
+// holding one contiguous array per component (and one for the owning entities), so a query walks plain arrays
+class Archetype
+{
+public:
+	static constexpr size_t chunkSize = 16 * 1024;
+
+	explicit Archetype(const ComponentMask& mask);
+
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	const ComponentMask& getMask() const { return m_mask; }
+	bool has(ComponentId id) const { return m_mask.test(id); }
+
+	uint32_t getCount() const { return m_count; }
+	uint32_t getChunkCapacity() const { return m_chunkCapacity; }
+	uint32_t getChunkCount() const { return (m_count + m_chunkCapacity - 1) / m_chunkCapacity; }
+	// rows used in chunk, every chunk but the last is full
+	uint32_t getChunkRows(uint32_t chunk) const;
+
+	// appends a row with uninitialized components, returns its index
+	uint32_t pushBack(Entity entity);
+	// fills row with the last row, returns the entity that moved into it (invalid if row was the last one)
+	Entity swapRemove(uint32_t row);
+
+	Entity getEntity(uint32_t row) const { return getEntities(row / m_chunkCapacity)[row % m_chunkCapacity]; }
+	void* getComponent(uint32_t row, ComponentId id);
+	const void* getComponent(uint32_t row, ComponentId id) const;
+
+	const Entity* getEntities(uint32_t chunk) const;
+	void* getColumn(uint32_t chunk, ComponentId id);
+
+	template<class T>
+	T* getColumn(uint32_t chunk)
+	{
+		return static_cast<T*>(getColumn(chunk, getComponentId<T>()));
+	}
+
+	// archetypes reached by adding or removing one component, filled in by World as it finds them
+	std::array<Archetype*, maxComponents> addEdges = {};
+	std::array<Archetype*, maxComponents> removeEdges = {};
+
+private:
+	struct alignas(64) Chunk
+	{
+		std::byte data[chunkSize];
+	};
+
+	struct Column
+	{
+		ComponentId id = 0;
+		uint32_t size = 0;
+		uint32_t alignment = 0;
+		uint32_t offset = 0;
+	};
+
+	std::byte* getRow(uint32_t row, const Column& column) const;
+
+	ComponentMask m_mask;
+	std::vector<Column> m_columns;
+	// m_columns index per component id, only valid for ids in m_mask
+	std::array<uint8_t, maxComponents> m_columnIndex = {};
+	uint32_t m_chunkCapacity = 0;
+
+	std::vector<std::unique_ptr<Chunk>> m_chunks;
+	uint32_t m_count = 0;
+};
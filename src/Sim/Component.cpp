@@ -0,0 +1,34 @@
+#include "Component.h"
+
+#include <array>
+#include <mutex>
+#include <stdexcept>
+
+#include "Utils/Logging.hpp"
+
+namespace
+{
+std::array<ComponentInfo, maxComponents> componentInfos;
+ComponentId componentCount = 0;
+std::mutex componentMutex;
+} // namespace
+
+ComponentId registerComponent(uint32_t size, uint32_t alignment)
+{
+	std::scoped_lock lock(componentMutex);
+
+	if (componentCount == maxComponents)
+	{
+		LOG_ERROR(LogCategory::Sim, "more than {} component types registered", maxComponents);
+		throw std::runtime_error("too many component types");
+	}
+
+	componentInfos[componentCount] = ComponentInfo { size, alignment };
+	return componentCount++;
+}
+
+const ComponentInfo& getComponentInfo(ComponentId id)
+{
+	// written once before the id is handed out and never changed again
+	return componentInfos[id];
+}
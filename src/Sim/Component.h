@@ -0,0 +1,39 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <type_traits>
+
+constexpr uint32_t maxComponents = 64;
+
+using ComponentId = uint32_t;
+using ComponentMask = std::bitset<maxComponents>;
+
+struct ComponentInfo
+{
+	uint32_t size = 0;
+	uint32_t alignment = 0;
+};
+
+// ids are handed out on first use, so they can differ between runs and must not be saved
+ComponentId registerComponent(uint32_t size, uint32_t alignment);
+const ComponentInfo& getComponentInfo(ComponentId id);
+
+template<class T>
+ComponentId getComponentId()
+{
+	// rows are moved between chunks and archetypes with memcpy
+	static_assert(std::is_trivially_copyable_v<T>, "components must be trivially copyable");
+	static_assert(alignof(T) <= 64, "components can't be aligned past a cache line");
+
+	static const ComponentId id = registerComponent(sizeof(T), alignof(T));
+	return id;
+}
+
+template<class ... Ts>
+ComponentMask makeComponentMask()
+{
+	ComponentMask mask;
+	(mask.set(getComponentId<Ts>()), ...);
+	return mask;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/vec2.hpp>
+
+struct Position
+{
+	glm::vec2 value;
+};
+
+// units per second
+struct Velocity
+{
+	glm::vec2 value;
+};
+
+// mirrors the SpriteInstance fields the sim decides, the position comes from Position
+struct Sprite
+{
+	uint32_t atlasIndex = 0;
+	// rgba8, red in the lowest byte
+	uint32_t tint = 0xffffffff;
+	uint32_t layer = 0;
+};
+
+// tags
+struct Colonist
+{
+};
+
+struct Item
+{
+};
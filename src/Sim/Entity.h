@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// index into the world's entity slots plus the generation of that slot, a handle to a destroyed entity keeps
+// its old generation and stops resolving once the slot is reused
+struct Entity
+{
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	uint32_t index = invalidIndex;
+	uint32_t generation = 0;
+
+	bool isValid() const { return index != invalidIndex; }
+	bool operator==(const Entity& other) const = default;
+};
+
+template<>
+struct std::hash<Entity>
+{
+	size_t operator()(const Entity& entity) const
+	{
+		return std::hash<uint64_t>()((static_cast<uint64_t>(entity.generation) << 32) | entity.index);
+	}
+};
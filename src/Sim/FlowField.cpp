@@ -0,0 +1,396 @@
+#include "FlowField.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Sim/PathFinder.h"
+#include "Utils/JobSystem.hpp"
+#include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
+
+namespace
+{
+// straight steps first, the diagonal ones need both straight neighbours walkable
+constexpr int stepX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+constexpr int stepY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+constexpr uint32_t straightCost = PathFinder::straightCost;
+constexpr uint32_t diagonalCost = PathFinder::diagonalCost;
+
+// unreachable stays unreachable, written so it vectorizes to a saturating add
+inline uint32_t addCost(uint32_t cost, uint32_t step)
+{
+	const uint32_t sum = cost + step;
+	return sum | -static_cast<uint32_t>(sum < cost);
+}
+
+// one padded row of a sweep relaxed from the row the sweep came from, straight and diagonal steps at once. no tile
+// depends on another in the same row, so the compiler turns this into a few SIMD instructions per vector of tiles.
+// returns the bits that changed
+uint32_t relaxRow(uint32_t* __restrict row, const uint32_t* __restrict from, const uint32_t* __restrict blocked,
+				  const uint32_t* __restrict blockedFrom)
+{
+	uint32_t difference = 0;
+	for (uint32_t x = 1; x <= TileChunk::size; x++)
+	{
+		uint32_t value = std::min(row[x], addCost(from[x], straightCost));
+		value = std::min(value, addCost(from[x - 1], diagonalCost) | blocked[x - 1] | blockedFrom[x]);
+		value = std::min(value, addCost(from[x + 1], diagonalCost) | blocked[x + 1] | blockedFrom[x]);
+		value |= blocked[x];
+		difference |= value ^ row[x];
+		row[x] = value;
+	}
+	return difference;
+}
+} // namespace
+
+uint32_t FlowField::getCost(glm::ivec2 tile) const
+{
+	if (!m_map->isInBounds(tile))
+		return unreachable;
+	return m_costs[m_map->getChunkIndex(tile)][TileMap::getLocalIndex(tile)];
+}
+
+glm::ivec2 FlowField::getDirection(glm::ivec2 tile) const
+{
+	if (!m_map->isInBounds(tile))
+		return { 0, 0 };
+
+	const uint8_t direction = m_directions[m_map->getChunkIndex(tile)][TileMap::getLocalIndex(tile)];
+	return direction == noDirection ? glm::ivec2(0, 0) : glm::ivec2(stepX[direction], stepY[direction]);
+}
+
+void FlowFieldCache::create(const TileMap& map, size_t capacity)
+{
+	m_map = &map;
+	m_capacity = capacity;
+
+	const glm::ivec2 chunkCount = map.getChunkCount();
+	const uint32_t count = static_cast<uint32_t>(chunkCount.x * chunkCount.y);
+	m_blocked.resize(count);
+	for (uint32_t chunk = 0; chunk < count; chunk++)
+		buildBlocked(chunk);
+
+	m_fields.clear();
+	m_fieldIndex.clear();
+}
+
+void FlowFieldCache::update(std::span<const uint32_t> changedChunks)
+{
+	if (changedChunks.empty())
+		return;
+
+	TRACE_ZONE("FlowFieldCache::update");
+
+	// roofs, stockpiles and rooms don't move anyone
+	std::vector<uint32_t> changed;
+	for (uint32_t chunk : changedChunks)
+	{
+		const std::array<uint32_t, TileChunk::tileCount> old = m_blocked[chunk];
+		buildBlocked(chunk);
+		if (old != m_blocked[chunk])
+			changed.push_back(chunk);
+	}
+
+	if (changed.empty() || m_fields.empty())
+		return;
+
+	// a chunk the field never reached can only start to matter if a neighbour was reached and it now connects
+	size_t dropped = 0;
+	for (auto it = m_fields.begin(); it != m_fields.end();)
+	{
+		const FlowField& field = *it->field;
+		const bool affected = std::ranges::any_of(changed, [&](uint32_t chunk) {
+			bool reached = field.m_reached[chunk] != 0;
+			forEachNeighbour(chunk, [&](uint32_t neighbour, int, int) { reached = reached || field.m_reached[neighbour] != 0; });
+			return reached;
+		});
+
+		if (affected)
+		{
+			m_fieldIndex.erase(it->key);
+			it = m_fields.erase(it);
+			dropped++;
+		}
+		else
+			++it;
+	}
+
+	if (dropped > 0)
+		LOG_DEBUG(LogCategory::Path, "{} flow fields dropped by tile edits in {} chunks", dropped, changed.size());
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::getField(glm::ivec2 target)
+{
+	const uint64_t key = getKey(target);
+	auto it = m_fieldIndex.find(key);
+	if (it != m_fieldIndex.end())
+	{
+		m_fields.splice(m_fields.begin(), m_fields, it->second);
+		return it->second->field;
+	}
+
+	std::shared_ptr<const FlowField> field = buildField(target);
+	m_fields.push_front(CachedField { key, field });
+	m_fieldIndex.emplace(key, m_fields.begin());
+
+	if (m_fields.size() > m_capacity)
+	{
+		m_fieldIndex.erase(m_fields.back().key);
+		m_fields.pop_back();
+	}
+	return field;
+}
+
+uint64_t FlowFieldCache::getKey(glm::ivec2 target)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(target.x)) << 32) | static_cast<uint32_t>(target.y);
+}
+
+void FlowFieldCache::buildBlocked(uint32_t chunk)
+{
+	const glm::ivec2 origin = m_map->getChunkOrigin(chunk);
+	for (uint32_t local = 0; local < TileChunk::tileCount; local++)
+	{
+		const glm::ivec2 tile = { origin.x + static_cast<int>(local & (TileChunk::size - 1)), origin.y + static_cast<int>(local >> TileChunk::sizeBits) };
+		m_blocked[chunk][local] = m_map->isWalkable(tile) ? 0 : UINT32_MAX;
+	}
+}
+
+std::shared_ptr<FlowField> FlowFieldCache::buildField(glm::ivec2 target)
+{
+	TRACE_ZONE("FlowFieldCache::buildField");
+
+	const glm::ivec2 chunkCount = m_map->getChunkCount();
+	const uint32_t count = static_cast<uint32_t>(chunkCount.x * chunkCount.y);
+
+	std::array<uint32_t, TileChunk::tileCount> unreached;
+	unreached.fill(FlowField::unreachable);
+	std::array<uint8_t, TileChunk::tileCount> undirected;
+	undirected.fill(FlowField::noDirection);
+
+	auto field = std::make_shared<FlowField>();
+	field->m_map = m_map;
+	field->m_target = target;
+	field->m_costs.assign(count, unreached);
+	field->m_directions.assign(count, undirected);
+	field->m_reached.assign(count, 0);
+	m_buildCount++;
+
+	// a blocked target reaches nothing, but its chunk still counts as reached so the field is dropped once the
+	// target can be walked on again
+	const uint32_t targetChunk = m_map->getChunkIndex(target);
+	if (!m_map->isWalkable(target))
+	{
+		field->m_reached[targetChunk] = 1;
+		return field;
+	}
+
+	m_published.assign(count, unreached);
+
+	field->m_costs[targetChunk][TileMap::getLocalIndex(target)] = 0;
+
+	// every round solves the chunks facing an edge tile that changed in the previous round
+	std::vector<uint32_t> active = { targetChunk };
+	std::vector<uint32_t> next;
+	std::vector<uint16_t> changedSides(count, 0);
+	std::vector<uint8_t> queued(count, 0);
+	uint32_t rounds = 0;
+	uint32_t solves = 0;
+
+	while (!active.empty())
+	{
+		JobSystem::ParallelFor(static_cast<uint32_t>(active.size()), 1, [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++)
+				changedSides[active[i]] = solveChunk(*field, active[i]);
+		});
+
+		rounds++;
+		solves += static_cast<uint32_t>(active.size());
+
+		next.clear();
+		for (uint32_t chunk : active)
+		{
+			if (changedSides[chunk] == 0)
+				continue;
+
+			m_published[chunk] = field->m_costs[chunk];
+			forEachNeighbour(chunk, [&](uint32_t neighbour, int dx, int dy) {
+				if ((changedSides[chunk] & getSideBit(dx, dy)) != 0 && !queued[neighbour])
+				{
+					queued[neighbour] = 1;
+					next.push_back(neighbour);
+				}
+			});
+		}
+
+		for (uint32_t chunk : next)
+			queued[chunk] = 0;
+		active.swap(next);
+	}
+
+	JobSystem::ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t chunk = begin; chunk < end; chunk++)
+		{
+			if (field->m_reached[chunk])
+				buildDirections(*field, chunk);
+		}
+	});
+
+	LOG_DEBUG(LogCategory::Path, "flow field to ({}, {}) in {} rounds, {} chunk solves", target.x, target.y, rounds, solves);
+	return field;
+}
+
+uint16_t FlowFieldCache::solveChunk(FlowField& field, uint32_t chunk) const
+{
+	thread_local PaddedTiles cost;
+	thread_local PaddedTiles blocked;
+	thread_local PaddedTiles transposedCost;
+	thread_local PaddedTiles transposedBlocked;
+
+	// the chunk's own tiles are the field's, only the border comes from the published costs
+	loadPadded(chunk, m_published, cost);
+	loadPadded(chunk, m_blocked, blocked);
+	std::array<uint32_t, TileChunk::tileCount>& costs = field.m_costs[chunk];
+	for (uint32_t y = 0; y < TileChunk::size; y++)
+		memcpy(&cost[(y + 1) * paddedSize + 1], &costs[y << TileChunk::sizeBits], TileChunk::size * sizeof(uint32_t));
+	transpose(blocked, transposedBlocked);
+
+	// relaxing a row only reads the row before it, so sweeping rows down and up vectorizes where sweeping along
+	// a row wouldn't. the left and right sweeps are the same thing on the transposed tiles. repeated until a
+	// full round changes nothing, twice in the open and more often around walls
+	const auto sweep = [](PaddedTiles& tiles, const PaddedTiles& walls) {
+		uint32_t difference = 0;
+		for (uint32_t y = 1; y <= TileChunk::size; y++)
+			difference |= relaxRow(&tiles[y * paddedSize], &tiles[(y - 1) * paddedSize], &walls[y * paddedSize], &walls[(y - 1) * paddedSize]);
+		for (uint32_t y = TileChunk::size; y >= 1; y--)
+			difference |= relaxRow(&tiles[y * paddedSize], &tiles[(y + 1) * paddedSize], &walls[y * paddedSize], &walls[(y + 1) * paddedSize]);
+		return difference;
+	};
+
+	for (;;)
+	{
+		uint32_t difference = sweep(cost, blocked);
+		transpose(cost, transposedCost);
+		difference |= sweep(transposedCost, transposedBlocked);
+		transpose(transposedCost, cost);
+
+		if (difference == 0)
+			break;
+	}
+
+	// which neighbours see a tile that changed, they only ever look at the outermost ring
+	const std::array<uint32_t, TileChunk::tileCount>& published = m_published[chunk];
+	const uint32_t last = TileChunk::size - 1;
+	const auto changed = [&](uint32_t local) { return cost[((local >> TileChunk::sizeBits) + 1) * paddedSize + (local & last) + 1] != published[local]; };
+
+	uint16_t sides = 0;
+	for (uint32_t i = 0; i < TileChunk::size; i++)
+	{
+		if (changed(i))
+			sides |= getSideBit(0, -1);
+		if (changed((last << TileChunk::sizeBits) | i))
+			sides |= getSideBit(0, 1);
+		if (changed(i << TileChunk::sizeBits))
+			sides |= getSideBit(-1, 0);
+		if (changed((i << TileChunk::sizeBits) | last))
+			sides |= getSideBit(1, 0);
+	}
+	if (changed(0))
+		sides |= getSideBit(-1, -1);
+	if (changed(last))
+		sides |= getSideBit(1, -1);
+	if (changed(last << TileChunk::sizeBits))
+		sides |= getSideBit(-1, 1);
+	if (changed((last << TileChunk::sizeBits) | last))
+		sides |= getSideBit(1, 1);
+
+	bool reached = false;
+	for (uint32_t y = 0; y < TileChunk::size; y++)
+	{
+		const uint32_t* row = &cost[(y + 1) * paddedSize + 1];
+		memcpy(&costs[y << TileChunk::sizeBits], row, TileChunk::size * sizeof(uint32_t));
+		reached = reached || std::any_of(row, row + TileChunk::size, [](uint32_t value) { return value != FlowField::unreachable; });
+	}
+	field.m_reached[chunk] = reached;
+
+	return sides;
+}
+
+void FlowFieldCache::buildDirections(FlowField& field, uint32_t chunk) const
+{
+	thread_local PaddedTiles cost;
+	thread_local PaddedTiles blocked;
+
+	// every chunk is final by now, so the neighbours are read straight from the field
+	loadPadded(chunk, field.m_costs, cost);
+	loadPadded(chunk, m_blocked, blocked);
+
+	std::array<uint8_t, TileChunk::tileCount>& directions = field.m_directions[chunk];
+	for (uint32_t local = 0; local < TileChunk::tileCount; local++)
+	{
+		const int x = static_cast<int>(local & (TileChunk::size - 1)) + 1;
+		const int y = static_cast<int>(local >> TileChunk::sizeBits) + 1;
+		const uint32_t index = static_cast<uint32_t>(y) * paddedSize + static_cast<uint32_t>(x);
+		if (cost[index] == FlowField::unreachable || cost[index] == 0)
+			continue;
+
+		// the neighbour the cost came from, straight steps win ties
+		uint64_t best = FlowField::unreachable;
+		for (uint8_t direction = 0; direction < 8; direction++)
+		{
+			const uint32_t to = static_cast<uint32_t>((y + stepY[direction]) * static_cast<int>(paddedSize) + x + stepX[direction]);
+			const bool diagonal = direction >= 4;
+			if (blocked[to] || (diagonal && (blocked[index + stepX[direction]] || blocked[index + stepY[direction] * static_cast<int>(paddedSize)])))
+				continue;
+
+			const uint64_t total = static_cast<uint64_t>(cost[to]) + (diagonal ? diagonalCost : straightCost);
+			if (cost[to] != FlowField::unreachable && total < best)
+			{
+				best = total;
+				directions[local] = direction;
+			}
+		}
+	}
+}
+
+void FlowFieldCache::transpose(const PaddedTiles& from, PaddedTiles& to)
+{
+	for (uint32_t y = 0; y < paddedSize; y++)
+	{
+		for (uint32_t x = 0; x < paddedSize; x++)
+			to[x * paddedSize + y] = from[y * paddedSize + x];
+	}
+}
+
+void FlowFieldCache::loadPadded(uint32_t chunk, const std::vector<std::array<uint32_t, TileChunk::tileCount>>& source, PaddedTiles& padded) const
+{
+	const uint32_t last = TileChunk::size - 1;
+	const uint32_t paddedLast = paddedSize - 1;
+
+	padded.fill(UINT32_MAX);
+	for (uint32_t y = 0; y < TileChunk::size; y++)
+		memcpy(&padded[(y + 1) * paddedSize + 1], &source[chunk][y << TileChunk::sizeBits], TileChunk::size * sizeof(uint32_t));
+
+	// the row, column or corner of each neighbour that touches this chunk
+	forEachNeighbour(chunk, [&](uint32_t neighbour, int dx, int dy) {
+		const std::array<uint32_t, TileChunk::tileCount>& tiles = source[neighbour];
+		const uint32_t fromX = dx < 0 ? last : 0;
+		const uint32_t fromY = dy < 0 ? last : 0;
+		const uint32_t toX = dx < 0 ? 0 : paddedLast;
+		const uint32_t toY = dy < 0 ? 0 : paddedLast;
+
+		if (dx != 0 && dy != 0)
+			padded[toY * paddedSize + toX] = tiles[(fromY << TileChunk::sizeBits) | fromX];
+		else if (dx != 0)
+		{
+			for (uint32_t y = 0; y < TileChunk::size; y++)
+				padded[(y + 1) * paddedSize + toX] = tiles[(y << TileChunk::sizeBits) | fromX];
+		}
+		else
+		{
+			for (uint32_t x = 0; x < TileChunk::size; x++)
+				padded[toY * paddedSize + x + 1] = tiles[(fromY << TileChunk::sizeBits) | x];
+		}
+	});
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Sim/TileMap.h"
+
+// cost to a target from every tile and the step to take toward it, so any number of movers heading to the same
+// place share one search. 8 connected without cutting blocked corners, with PathFinder's step costs
+class FlowField
+{
+public:
+	static constexpr uint32_t unreachable = UINT32_MAX;
+
+	glm::ivec2 getTarget() const { return m_target; }
+
+	// unreachable for blocked tiles, tiles that can't reach the target and tiles out of bounds
+	uint32_t getCost(glm::ivec2 tile) const;
+	bool isReachable(glm::ivec2 tile) const { return getCost(tile) != unreachable; }
+	// one step toward the target, { 0, 0 } on the target and wherever it is unreachable
+	glm::ivec2 getDirection(glm::ivec2 tile) const;
+
+private:
+	friend class FlowFieldCache;
+
+	static constexpr uint8_t noDirection = UINT8_MAX;
+
+	const TileMap* m_map = nullptr;
+	glm::ivec2 m_target = { 0, 0 };
+
+	std::vector<std::array<uint32_t, TileChunk::tileCount>> m_costs;
+	// index into the step tables, noDirection where there is nowhere to go
+	std::vector<std::array<uint8_t, TileChunk::tileCount>> m_directions;
+	// chunks the search reached, a tile edit can only change the field in or next to one of them
+	std::vector<uint8_t> m_reached;
+};
+
+// flow fields by target, built on first use and kept until a walkability change could affect them. a build is a
+// wavefront over chunks, every round solves the chunks whose neighbours' edges changed in the last one, one
+// chunk per job. inside a chunk costs are relaxed with sweeps over whole rows at a time, which the compiler
+// turns into SIMD, until nothing changes. chunks the target can't reach are never solved
+class FlowFieldCache
+{
+public:
+	// the map must outlive the cache, capacity is the number of fields kept before the least recently used goes
+	void create(const TileMap& map, size_t capacity = 16);
+
+	// drops the fields the changed chunks' walkability could affect
+	void update(std::span<const uint32_t> changedChunks);
+
+	// the field toward target, built now if it isn't cached. sim thread only, a field stays valid for as long
+	// as it is held but stops matching the map once the cache drops it, so movers should get it again every tick
+	std::shared_ptr<const FlowField> getField(glm::ivec2 target);
+
+	size_t getFieldCount() const { return m_fields.size(); }
+	uint64_t getBuildCount() const { return m_buildCount; }
+
+private:
+	// a chunk's tiles with a one tile border from its neighbours, so the sweeps never check chunk bounds
+	static constexpr uint32_t paddedSize = TileChunk::size + 2;
+	static constexpr uint32_t paddedCount = paddedSize * paddedSize;
+	using PaddedTiles = std::array<uint32_t, paddedCount>;
+
+	struct CachedField
+	{
+		uint64_t key;
+		std::shared_ptr<const FlowField> field;
+	};
+
+	static uint64_t getKey(glm::ivec2 target);
+
+	void buildBlocked(uint32_t chunk);
+	std::shared_ptr<FlowField> buildField(glm::ivec2 target);
+	// one bit per neighbour, see getSideBit
+	static uint16_t getSideBit(int dx, int dy) { return static_cast<uint16_t>(1u << ((dy + 1) * 3 + dx + 1)); }
+	static void transpose(const PaddedTiles& from, PaddedTiles& to);
+
+	// relaxes one chunk against the costs its neighbours last published, returns the neighbours that see a
+	// changed tile
+	uint16_t solveChunk(FlowField& field, uint32_t chunk) const;
+	void buildDirections(FlowField& field, uint32_t chunk) const;
+
+	// the chunk's tiles from source with the neighbouring tiles around them, all bits set outside the map
+	void loadPadded(uint32_t chunk, const std::vector<std::array<uint32_t, TileChunk::tileCount>>& source, PaddedTiles& padded) const;
+	// func(uint32_t neighbour, int dx, int dy) for every chunk around chunk, diagonal ones included
+	template<class Func>
+	void forEachNeighbour(uint32_t chunk, Func&& func) const;
+
+	const TileMap* m_map = nullptr;
+	size_t m_capacity = 0;
+
+	// per tile, all bits set where it isn't walkable so or-ing it into a cost makes it unreachable
+	std::vector<std::array<uint32_t, TileChunk::tileCount>> m_blocked;
+
+	// build scratch, every chunk's costs as of the last round that changed its edge tiles. solving chunks only
+	// read their neighbours from here, so chunks next to each other can be solved at the same time
+	std::vector<std::array<uint32_t, TileChunk::tileCount>> m_published;
+
+	// least recently used field at the back
+	std::list<CachedField> m_fields;
+	std::unordered_map<uint64_t, std::list<CachedField>::iterator> m_fieldIndex;
+	uint64_t m_buildCount = 0;
+};
+
+template<class Func>
+void FlowFieldCache::forEachNeighbour(uint32_t chunk, Func&& func) const
+{
+	const glm::ivec2 chunkCount = m_map->getChunkCount();
+	const int x = static_cast<int>(chunk % chunkCount.x);
+	const int y = static_cast<int>(chunk / chunkCount.x);
+
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			const int nx = x + dx;
+			const int ny = y + dy;
+			if ((dx != 0 || dy != 0) && nx >= 0 && ny >= 0 && nx < chunkCount.x && ny < chunkCount.y)
+				func(static_cast<uint32_t>(ny * chunkCount.x + nx), dx, dy);
+		}
+	}
+}
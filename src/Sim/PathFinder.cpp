@@ -0,0 +1,758 @@
+#include "PathFinder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <chrono>
+#include <functional>
+
+#include "Utils/JobSystem.hpp"
+#include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
+
+namespace
+{
+constexpr uint32_t unreachable = UINT32_MAX;
+
+// straight steps first, the diagonal ones need both straight neighbours walkable
+constexpr int stepX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+constexpr int stepY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+// scratch for the abstract search, sized to the node count plus the two temporary start and goal nodes
+struct AbstractSearch
+{
+	std::vector<uint32_t> cost;
+	std::vector<uint32_t> parent;
+	std::vector<uint32_t> visited;
+	// cost from a node in the goal chunk to the goal, only read for nodes in that chunk
+	std::vector<uint32_t> goalCost;
+	uint32_t epoch = 0;
+	// f in the high half and h in the low half, so among equal f the node closest to the goal comes first.
+	// entrances at both ends of every open border make lots of equally good routes, without the tie break
+	// the search expands most of them
+	std::vector<std::pair<uint64_t, uint32_t>> open;
+	std::vector<uint32_t> nodes;
+};
+
+thread_local AbstractSearch t_abstractSearch;
+
+glm::ivec2 getTile(glm::ivec2 chunkOrigin, uint32_t local)
+{
+	return { chunkOrigin.x + static_cast<int>(local & (TileChunk::size - 1)), chunkOrigin.y + static_cast<int>(local >> TileChunk::sizeBits) };
+}
+thread_local std::vector<glm::ivec2> t_cachedTiles;
+thread_local std::vector<glm::ivec2> t_smoothedPath;
+thread_local std::vector<glm::ivec2> t_abstractPath;
+} // namespace
+
+// per chunk search state, visited holds the epoch a tile was last reached in so nothing is cleared between searches.
+// with a consistent heuristic a step raises f by at most two diagonal steps, so the open list is a ring of buckets
+// indexed by f instead of a heap (Dial's algorithm)
+struct PathFinder::ClusterSearch
+{
+	static constexpr uint32_t bucketCount = 32;
+	static_assert(bucketCount > 2 * diagonalCost);
+
+	std::array<uint32_t, TileChunk::tileCount> cost;
+	std::array<uint16_t, TileChunk::tileCount> parent;
+	std::array<uint32_t, TileChunk::tileCount> visited = {};
+	uint32_t epoch = 0;
+	std::array<std::vector<uint16_t>, bucketCount> buckets;
+	// node tiles a flood has yet to settle
+	std::bitset<TileChunk::tileCount> targets;
+
+	uint32_t getCost(uint32_t local) const { return visited[local] == epoch ? cost[local] : unreachable; }
+};
+
+PathFinder::ClusterSearch& PathFinder::getClusterSearch(uint32_t slot)
+{
+	thread_local std::array<ClusterSearch, 2> searches;
+	return searches[slot];
+}
+
+void PathFinder::create(const TileMap& map, size_t cacheCapacity)
+{
+	TRACE_ZONE("PathFinder::create");
+	const auto start = std::chrono::steady_clock::now();
+
+	m_map = &map;
+	m_cacheCapacity = cacheCapacity;
+
+	const glm::ivec2 chunkCount = map.getChunkCount();
+	const uint32_t clusterCount = static_cast<uint32_t>(chunkCount.x * chunkCount.y);
+
+	m_nodes.clear();
+	m_freeNodes.clear();
+	m_clusterNodes.assign(clusterCount, {});
+	m_clusterPaths.assign(clusterCount, {});
+	m_borderNodes.assign(clusterCount * 2, {});
+	m_moves.resize(clusterCount);
+
+	for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+		buildMoves(cluster);
+
+	for (uint32_t border = 0; border < clusterCount * 2; border++)
+		buildBorder(border);
+
+	JobSystem::ParallelFor(clusterCount, 1, [this](uint32_t begin, uint32_t end) {
+		for (uint32_t cluster = begin; cluster < end; cluster++)
+			buildClusterEdges(cluster);
+	});
+
+	{
+		std::scoped_lock lock(m_cacheMutex);
+		m_cache.clear();
+		m_cacheIndex.clear();
+	}
+
+	LOG_INFO(LogCategory::Path, "path graph of {} nodes over {} chunks in {:.2f}ms", getNodeCount(), clusterCount,
+			 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+void PathFinder::update(std::span<const uint32_t> changedChunks)
+{
+	if (changedChunks.empty())
+		return;
+
+	TRACE_ZONE("PathFinder::update");
+
+	const glm::ivec2 chunkCount = m_map->getChunkCount();
+	std::vector<uint32_t> borders;
+	std::vector<uint32_t> clusters;
+
+	// a chunk's tiles decide the entrances on its four borders, and those entrances are nodes in its four
+	// neighbours too
+	for (uint32_t chunk : changedChunks)
+	{
+		const uint32_t x = chunk % chunkCount.x;
+		const uint32_t y = chunk / chunkCount.x;
+
+		borders.push_back(chunk * 2);
+		borders.push_back(chunk * 2 + 1);
+		clusters.push_back(chunk);
+
+		if (x > 0)
+		{
+			borders.push_back((chunk - 1) * 2);
+			clusters.push_back(chunk - 1);
+		}
+		if (y > 0)
+		{
+			borders.push_back((chunk - chunkCount.x) * 2 + 1);
+			clusters.push_back(chunk - chunkCount.x);
+		}
+		if (x + 1 < static_cast<uint32_t>(chunkCount.x))
+			clusters.push_back(chunk + 1);
+		if (y + 1 < static_cast<uint32_t>(chunkCount.y))
+			clusters.push_back(chunk + chunkCount.x);
+	}
+
+	std::ranges::sort(borders);
+	borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+	std::ranges::sort(clusters);
+	clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+
+	for (uint32_t chunk : changedChunks)
+		buildMoves(chunk);
+
+	for (uint32_t border : borders)
+	{
+		removeBorder(border);
+		buildBorder(border);
+	}
+
+	JobSystem::ParallelFor(static_cast<uint32_t>(clusters.size()), 1, [this, &clusters](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+			buildClusterEdges(clusters[i]);
+	});
+
+	// cached paths are only dropped when they cross a changed chunk. one that could now take a shortcut stays
+	// valid, just no longer the best
+	std::vector<uint32_t> changed(changedChunks.begin(), changedChunks.end());
+	std::ranges::sort(changed);
+
+	std::scoped_lock lock(m_cacheMutex);
+	for (auto it = m_cache.begin(); it != m_cache.end();)
+	{
+		const bool crossesChange = std::ranges::any_of(changed, [&it](uint32_t chunk) { return std::ranges::binary_search(it->chunks, chunk); });
+
+		if (crossesChange)
+		{
+			m_cacheIndex.erase(it->key);
+			it = m_cache.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+bool PathFinder::findPath(glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path)
+{
+	path.clear();
+	if (!m_map->isWalkable(start) || !m_map->isWalkable(goal))
+		return false;
+
+	const uint32_t startCluster = m_map->getChunkIndex(start);
+	const uint32_t goalCluster = m_map->getChunkIndex(goal);
+
+	// staying inside one chunk is nearly always possible and then needs no abstract search at all, unless a wall
+	// inside the chunk makes it a detour a route through the neighbours could beat
+	if (startCluster == goalCluster)
+	{
+		path.push_back(start);
+		if (findClusterPath(startCluster, start, goal, path))
+		{
+			std::vector<glm::ivec2>& around = t_abstractPath;
+			if (isShortcutCostOk(path) || !findAbstractPath(startCluster, goalCluster, start, goal, around))
+				return true;
+
+			smoothPath(around);
+			if (getPathCost(around) < getPathCost(path))
+				path.assign(around.begin(), around.end());
+			return true;
+		}
+		path.clear();
+	}
+	else if (findCachedPath(startCluster, goalCluster, start, goal, path))
+	{
+		smoothPath(path);
+		return true;
+	}
+
+	if (!findAbstractPath(startCluster, goalCluster, start, goal, path))
+		return false;
+
+	smoothPath(path);
+	return true;
+}
+
+uint32_t PathFinder::getHeuristic(glm::ivec2 from, glm::ivec2 to)
+{
+	const uint32_t dx = static_cast<uint32_t>(std::abs(from.x - to.x));
+	const uint32_t dy = static_cast<uint32_t>(std::abs(from.y - to.y));
+	return straightCost * std::max(dx, dy) + (diagonalCost - straightCost) * std::min(dx, dy);
+}
+
+uint64_t PathFinder::getPathCost(std::span<const glm::ivec2> path)
+{
+	uint64_t cost = 0;
+	for (size_t i = 1; i < path.size(); i++)
+		cost += path[i].x != path[i - 1].x && path[i].y != path[i - 1].y ? diagonalCost : straightCost;
+	return cost;
+}
+
+void PathFinder::smoothPath(std::vector<glm::ivec2>& path) const
+{
+	if (path.size() < 3)
+		return;
+
+	// every step of the line, false as soon as one isn't legal
+	const auto isLineWalkable = [this](glm::ivec2 from, glm::ivec2 to) {
+		return walkLine(from, to, [this](glm::ivec2 tile, glm::ivec2 next) {
+			return m_map->isWalkable(next) && (tile.x == next.x || tile.y == next.y || (m_map->isWalkable({ next.x, tile.y }) && m_map->isWalkable({ tile.x, next.y })));
+		});
+	};
+
+	std::vector<glm::ivec2>& smoothed = t_smoothedPath;
+	smoothed.clear();
+	smoothed.push_back(path.front());
+
+	// from each anchor jump to the furthest tile it sees in a straight line. lines are drawn with as many
+	// diagonal steps as possible, so a shortcut never costs more than the stretch it replaces
+	size_t anchor = 0;
+	while (anchor + 1 < path.size())
+	{
+		const size_t limit = std::min(path.size() - 1, anchor + maxSmoothingSpan);
+		size_t end = anchor + 1;
+		while (end < limit && isLineWalkable(path[anchor], path[end + 1]))
+			end++;
+
+		walkLine(path[anchor], path[end], [&smoothed](glm::ivec2, glm::ivec2 next) {
+			smoothed.push_back(next);
+			return true;
+		});
+		anchor = end;
+	}
+
+	path.assign(smoothed.begin(), smoothed.end());
+}
+
+void PathFinder::buildMoves(uint32_t cluster)
+{
+	const glm::ivec2 origin = m_map->getChunkOrigin(cluster);
+	const int size = static_cast<int>(TileChunk::size);
+
+	std::array<uint32_t, TileChunk::size> rows;
+	for (int y = 0; y < size; y++)
+	{
+		rows[y] = 0;
+		for (int x = 0; x < size; x++)
+		{
+			if (m_map->isWalkable({ origin.x + x, origin.y + y }))
+				rows[y] |= 1u << x;
+		}
+	}
+
+	const auto walkable = [&rows, size](int x, int y) { return x >= 0 && y >= 0 && x < size && y < size && ((rows[y] >> x) & 1) != 0; };
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			uint8_t moves = 0;
+			for (int direction = 0; direction < 8 && walkable(x, y); direction++)
+			{
+				const int toX = x + stepX[direction];
+				const int toY = y + stepY[direction];
+				const bool diagonal = direction >= 4;
+				if (walkable(toX, toY) && (!diagonal || (walkable(toX, y) && walkable(x, toY))))
+					moves |= 1 << direction;
+			}
+			m_moves[cluster][(y << TileChunk::sizeBits) | x] = moves;
+		}
+	}
+}
+
+void PathFinder::buildBorder(uint32_t border)
+{
+	const uint32_t cluster = border / 2;
+	const bool east = border % 2 == 0;
+	const glm::ivec2 chunkCount = m_map->getChunkCount();
+
+	// the last column and row of chunks have nothing on the other side
+	if ((east && cluster % chunkCount.x == static_cast<uint32_t>(chunkCount.x) - 1) ||
+		(!east && cluster / chunkCount.x == static_cast<uint32_t>(chunkCount.y) - 1))
+		return;
+
+	const int size = static_cast<int>(TileChunk::size);
+	const glm::ivec2 origin = m_map->getChunkOrigin(cluster);
+	const glm::ivec2 first = east ? glm::ivec2(origin.x + size - 1, origin.y) : glm::ivec2(origin.x, origin.y + size - 1);
+	const glm::ivec2 step = east ? glm::ivec2(0, 1) : glm::ivec2(1, 0);
+	const glm::ivec2 across = east ? glm::ivec2(1, 0) : glm::ivec2(0, 1);
+
+	int runStart = -1;
+	for (int i = 0; i <= size; i++)
+	{
+		const glm::ivec2 tile = { first.x + step.x * i, first.y + step.y * i };
+		const bool open = i < size && m_map->isWalkable(tile) && m_map->isWalkable({ tile.x + across.x, tile.y + across.y });
+
+		if (open && runStart < 0)
+			runStart = i;
+		else if (!open && runStart >= 0)
+		{
+			const int runEnd = i - 1;
+			if (runEnd - runStart + 1 < splitEntranceLength)
+			{
+				const int middle = (runStart + runEnd) / 2;
+				addEntrance(border, { first.x + step.x * middle, first.y + step.y * middle }, across);
+			}
+			else
+			{
+				addEntrance(border, { first.x + step.x * runStart, first.y + step.y * runStart }, across);
+				addEntrance(border, { first.x + step.x * runEnd, first.y + step.y * runEnd }, across);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+void PathFinder::removeBorder(uint32_t border)
+{
+	for (uint32_t id : m_borderNodes[border])
+	{
+		Node& node = m_nodes[id];
+		std::erase(m_clusterNodes[node.cluster], id);
+
+		node = Node {};
+		m_freeNodes.push_back(id);
+	}
+	m_borderNodes[border].clear();
+}
+
+void PathFinder::addEntrance(uint32_t border, glm::ivec2 tile, glm::ivec2 across)
+{
+	const uint32_t inside = allocateNode(tile, border);
+	const uint32_t outside = allocateNode({ tile.x + across.x, tile.y + across.y }, border);
+	m_nodes[inside].partner = outside;
+	m_nodes[outside].partner = inside;
+}
+
+uint32_t PathFinder::allocateNode(glm::ivec2 tile, uint32_t border)
+{
+	uint32_t id;
+	if (!m_freeNodes.empty())
+	{
+		id = m_freeNodes.back();
+		m_freeNodes.pop_back();
+	}
+	else
+	{
+		id = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.emplace_back();
+	}
+
+	Node& node = m_nodes[id];
+	node.tile = tile;
+	node.cluster = m_map->getChunkIndex(tile);
+	node.border = border;
+
+	m_clusterNodes[node.cluster].push_back(id);
+	m_borderNodes[border].push_back(id);
+	return id;
+}
+
+void PathFinder::buildClusterEdges(uint32_t cluster)
+{
+	ClusterSearch& search = getClusterSearch();
+
+	// one flood per node finds its path to every other node of the chunk. each cluster only writes its own
+	// nodes and paths, so clusters build in parallel
+	const std::vector<uint32_t>& nodes = m_clusterNodes[cluster];
+	std::vector<uint16_t>& paths = m_clusterPaths[cluster];
+	paths.clear();
+
+	for (uint32_t id : nodes)
+	{
+		Node& node = m_nodes[id];
+		node.edges.clear();
+		searchCluster(cluster, node.tile, nullptr, search);
+
+		const uint16_t nodeLocal = static_cast<uint16_t>(TileMap::getLocalIndex(node.tile));
+		for (uint32_t other : nodes)
+		{
+			const uint16_t otherLocal = static_cast<uint16_t>(TileMap::getLocalIndex(m_nodes[other].tile));
+			const uint32_t cost = search.getCost(otherLocal);
+			if (other == id || cost == unreachable)
+				continue;
+
+			// the parents lead from other back to this node
+			const uint32_t offset = static_cast<uint32_t>(paths.size());
+			for (uint16_t local = otherLocal; local != nodeLocal; local = search.parent[local])
+				paths.push_back(local);
+			std::reverse(paths.begin() + offset, paths.end());
+
+			node.edges.push_back(Edge { other, cost, offset, static_cast<uint32_t>(paths.size()) - offset });
+		}
+	}
+}
+
+bool PathFinder::searchCluster(uint32_t cluster, glm::ivec2 start, const glm::ivec2* goal, ClusterSearch& search) const
+{
+	if (++search.epoch == 0)
+	{
+		search.visited.fill(0);
+		search.epoch = 1;
+	}
+
+	const glm::ivec2 origin = m_map->getChunkOrigin(cluster);
+	const int size = static_cast<int>(TileChunk::size);
+	const auto heuristic = [goal](glm::ivec2 tile) { return goal != nullptr ? getHeuristic(tile, *goal) : 0u; };
+
+	// in chunk coordinates from here on
+	const std::array<uint8_t, TileChunk::tileCount>& moves = m_moves[cluster];
+
+	const uint16_t startLocal = static_cast<uint16_t>(TileMap::getLocalIndex(start));
+	search.cost[startLocal] = 0;
+	search.parent[startLocal] = startLocal;
+	search.visited[startLocal] = search.epoch;
+
+	for (std::vector<uint16_t>& bucket : search.buckets)
+		bucket.clear();
+
+	// a flood is only ever read at the cluster's nodes, so it can stop once they are all settled
+	uint32_t targetsLeft = 0;
+	if (goal == nullptr)
+	{
+		search.targets.reset();
+		for (uint32_t id : m_clusterNodes[cluster])
+			search.targets.set(TileMap::getLocalIndex(m_nodes[id].tile));
+		targetsLeft = static_cast<uint32_t>(search.targets.count());
+		if (targetsLeft == 0)
+			return true;
+	}
+
+	uint32_t current = heuristic(start);
+	search.buckets[current % ClusterSearch::bucketCount].push_back(startLocal);
+	uint32_t pending = 1;
+
+	const uint16_t goalLocal = goal != nullptr ? static_cast<uint16_t>(TileMap::getLocalIndex(*goal)) : uint16_t(UINT16_MAX);
+	while (pending > 0)
+	{
+		std::vector<uint16_t>& bucket = search.buckets[current % ClusterSearch::bucketCount];
+		if (bucket.empty())
+		{
+			current++;
+			continue;
+		}
+
+		const uint16_t local = bucket.back();
+		bucket.pop_back();
+		pending--;
+
+		// tiles are pushed again when a cheaper way is found, the old entry is skipped here
+		const int tileX = local & (size - 1);
+		const int tileY = local >> TileChunk::sizeBits;
+		if (search.cost[local] + heuristic({ origin.x + tileX, origin.y + tileY }) != current)
+			continue;
+		if (local == goalLocal)
+			return true;
+		if (search.targets.test(local))
+		{
+			search.targets.reset(local);
+			if (--targetsLeft == 0)
+				return true;
+		}
+
+		for (uint32_t bits = moves[local]; bits != 0; bits &= bits - 1)
+		{
+			const int direction = std::countr_zero(bits);
+			const int x = tileX + stepX[direction];
+			const int y = tileY + stepY[direction];
+			const bool diagonal = direction >= 4;
+
+			const uint16_t next = static_cast<uint16_t>((y << TileChunk::sizeBits) | x);
+			const uint32_t cost = search.cost[local] + (diagonal ? diagonalCost : straightCost);
+			if (search.getCost(next) <= cost)
+				continue;
+
+			search.cost[next] = cost;
+			search.parent[next] = local;
+			search.visited[next] = search.epoch;
+			search.buckets[(cost + heuristic({ origin.x + x, origin.y + y })) % ClusterSearch::bucketCount].push_back(next);
+			pending++;
+		}
+	}
+
+	return goal == nullptr;
+}
+
+bool PathFinder::findClusterPath(uint32_t cluster, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path) const
+{
+	if (start == goal)
+		return true;
+
+	ClusterSearch& search = getClusterSearch();
+
+	if (!searchCluster(cluster, start, &goal, search))
+		return false;
+
+	// the parents lead from the goal back to the start
+	const size_t first = path.size();
+	appendParents(search, cluster, static_cast<uint16_t>(TileMap::getLocalIndex(goal)), static_cast<uint16_t>(TileMap::getLocalIndex(start)), path);
+	std::reverse(path.begin() + first, path.end());
+	return true;
+}
+
+void PathFinder::appendParents(const ClusterSearch& search, uint32_t cluster, uint16_t from, uint16_t until, std::vector<glm::ivec2>& path) const
+{
+	const glm::ivec2 origin = m_map->getChunkOrigin(cluster);
+	for (uint16_t local = from; local != until; local = search.parent[local])
+		path.push_back(getTile(origin, local));
+}
+
+bool PathFinder::findCachedPath(uint32_t startCluster, uint32_t goalCluster, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path)
+{
+	const uint64_t key = (static_cast<uint64_t>(startCluster) << 32) | goalCluster;
+	std::vector<glm::ivec2>& tiles = t_cachedTiles;
+
+	{
+		std::scoped_lock lock(m_cacheMutex);
+		auto it = m_cacheIndex.find(key);
+		if (it == m_cacheIndex.end())
+		{
+			m_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_cache.splice(m_cache.begin(), m_cache, it->second);
+		tiles = it->second->tiles;
+	}
+
+	// the cached stretch starts and ends on entrance nodes, which this start or goal may not reach inside
+	// their chunk even though the original request's did
+	path.push_back(start);
+	if (!findClusterPath(startCluster, start, tiles.front(), path))
+	{
+		path.clear();
+		m_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	path.insert(path.end(), tiles.begin() + 1, tiles.end());
+	if (!findClusterPath(goalCluster, tiles.back(), goal, path))
+	{
+		path.clear();
+		m_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// the stretch was the best route for the request that stored it, whose start or goal may have been on the
+	// far side of a wall from these. a route that might be a long detour here is searched again instead
+	if (!isShortcutCostOk(path))
+	{
+		path.clear();
+		m_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool PathFinder::findAbstractPath(uint32_t startCluster, uint32_t goalCluster, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path)
+{
+	ClusterSearch& startFlood = getClusterSearch(0);
+	ClusterSearch& goalFlood = getClusterSearch(1);
+	AbstractSearch& search = t_abstractSearch;
+
+	const uint32_t nodeCount = static_cast<uint32_t>(m_nodes.size());
+	const uint32_t startId = nodeCount;
+	const uint32_t goalId = nodeCount + 1;
+
+	if (search.visited.size() < nodeCount + 2)
+	{
+		search.cost.resize(nodeCount + 2);
+		search.parent.resize(nodeCount + 2);
+		search.visited.resize(nodeCount + 2, 0);
+		search.goalCost.resize(nodeCount + 2);
+	}
+	if (++search.epoch == 0)
+	{
+		std::ranges::fill(search.visited, 0);
+		search.epoch = 1;
+	}
+
+	const auto getCost = [&search](uint32_t id) { return search.visited[id] == search.epoch ? search.cost[id] : unreachable; };
+	const auto heuristic = [&](uint32_t id) { return id == goalId ? 0u : getHeuristic(m_nodes[id].tile, goal); };
+	const auto relax = [&](uint32_t id, uint32_t parent, uint32_t cost) {
+		if (getCost(id) <= cost)
+			return;
+
+		search.cost[id] = cost;
+		search.parent[id] = parent;
+		search.visited[id] = search.epoch;
+		const uint32_t h = heuristic(id);
+		search.open.emplace_back((static_cast<uint64_t>(cost + h) << 32) | h, id);
+		std::ranges::push_heap(search.open, std::greater {});
+	};
+
+	// costs are symmetric, so a flood from the goal gives every goal chunk node's distance to it
+	searchCluster(goalCluster, goal, nullptr, goalFlood);
+	for (uint32_t id : m_clusterNodes[goalCluster])
+		search.goalCost[id] = goalFlood.getCost(TileMap::getLocalIndex(m_nodes[id].tile));
+
+	search.open.clear();
+	search.cost[startId] = 0;
+	search.visited[startId] = search.epoch;
+
+	searchCluster(startCluster, start, nullptr, startFlood);
+	for (uint32_t id : m_clusterNodes[startCluster])
+	{
+		const uint32_t cost = startFlood.getCost(TileMap::getLocalIndex(m_nodes[id].tile));
+		if (cost != unreachable)
+			relax(id, startId, cost);
+	}
+
+	bool found = false;
+	while (!search.open.empty())
+	{
+		std::ranges::pop_heap(search.open, std::greater {});
+		const auto [priority, id] = search.open.back();
+		search.open.pop_back();
+
+		if ((priority >> 32) > search.cost[id] + heuristic(id))
+			continue;
+		if (id == goalId)
+		{
+			found = true;
+			break;
+		}
+
+		const Node& node = m_nodes[id];
+		const uint32_t cost = search.cost[id];
+
+		relax(node.partner, id, cost + straightCost);
+		for (const Edge& edge : node.edges)
+			relax(edge.to, id, cost + edge.cost);
+
+		if (node.cluster == goalCluster && search.goalCost[id] != unreachable)
+			relax(goalId, id, cost + search.goalCost[id]);
+	}
+
+	if (!found)
+		return false;
+
+	search.nodes.clear();
+	for (uint32_t id = search.parent[goalId]; id != startId; id = search.parent[id])
+		search.nodes.push_back(id);
+	std::ranges::reverse(search.nodes);
+
+	// no tile searches left: the floods' parents lead from the first node back to the start and from the last
+	// node on to the goal, edges carry their own tiles and crossing a border is one step between partners
+	path.clear();
+	path.push_back(start);
+
+	const Node& firstNode = m_nodes[search.nodes.front()];
+	appendParents(startFlood, startCluster, static_cast<uint16_t>(TileMap::getLocalIndex(firstNode.tile)),
+				  static_cast<uint16_t>(TileMap::getLocalIndex(start)), path);
+	std::reverse(path.begin() + 1, path.end());
+	const size_t middleStart = path.size() - 1;
+
+	for (size_t i = 1; i < search.nodes.size(); i++)
+	{
+		const Node& from = m_nodes[search.nodes[i - 1]];
+		const Node& to = m_nodes[search.nodes[i]];
+		if (from.cluster != to.cluster)
+		{
+			path.push_back(to.tile);
+			continue;
+		}
+
+		const auto edge = std::ranges::find(from.edges, search.nodes[i], &Edge::to);
+		const glm::ivec2 origin = m_map->getChunkOrigin(from.cluster);
+		const std::vector<uint16_t>& paths = m_clusterPaths[from.cluster];
+		for (uint32_t j = edge->pathOffset; j < edge->pathOffset + edge->pathLength; j++)
+			path.push_back(getTile(origin, paths[j]));
+	}
+
+	const size_t middleEnd = path.size() - 1;
+	const uint16_t lastLocal = static_cast<uint16_t>(TileMap::getLocalIndex(m_nodes[search.nodes.back()].tile));
+	const uint16_t goalLocal = static_cast<uint16_t>(TileMap::getLocalIndex(goal));
+	if (lastLocal != goalLocal)
+	{
+		appendParents(goalFlood, goalCluster, goalFlood.parent[lastLocal], goalLocal, path);
+		path.push_back(goal);
+	}
+
+	if (startCluster != goalCluster && !search.nodes.empty())
+		storeCachedPath((static_cast<uint64_t>(startCluster) << 32) | goalCluster,
+						std::span<const glm::ivec2>(path).subspan(middleStart, middleEnd - middleStart + 1));
+
+	return true;
+}
+
+void PathFinder::storeCachedPath(uint64_t key, std::span<const glm::ivec2> tiles)
+{
+	if (m_cacheCapacity == 0)
+		return;
+
+	CachedPath cached { key, std::vector<glm::ivec2>(tiles.begin(), tiles.end()), {} };
+	for (glm::ivec2 tile : tiles)
+		cached.chunks.push_back(m_map->getChunkIndex(tile));
+	std::ranges::sort(cached.chunks);
+	cached.chunks.erase(std::unique(cached.chunks.begin(), cached.chunks.end()), cached.chunks.end());
+
+	std::scoped_lock lock(m_cacheMutex);
+	auto it = m_cacheIndex.find(key);
+	if (it != m_cacheIndex.end())
+		m_cache.erase(it->second);
+
+	m_cache.push_front(std::move(cached));
+	m_cacheIndex[key] = m_cache.begin();
+
+	if (m_cache.size() > m_cacheCapacity)
+	{
+		m_cacheIndex.erase(m_cache.back().key);
+		m_cache.pop_back();
+	}
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Sim/TileMap.h"
+
+// hierarchical A* (HPA*) over a TileMap. every chunk is a cluster, walkable runs along the border between two
+// chunks get one or two entrances, each a pair of nodes facing each other across the border. nodes in the same
+// chunk are joined by their exact in-chunk path, stored with the edge, so a search runs over the small abstract
+// graph and only searches tiles in the start and goal chunks. paths are 8 connected without cutting blocked
+// corners and close to, but not always exactly, the shortest
+class PathFinder
+{
+public:
+	static constexpr uint32_t straightCost = 10;
+	static constexpr uint32_t diagonalCost = 14;
+
+	// the map must outlive the path finder
+	void create(const TileMap& map, size_t cacheCapacity = 1024);
+
+	// rebuilds the entrances and edges around chunks whose tiles changed, and drops cached paths through them
+	void update(std::span<const uint32_t> changedChunks);
+
+	// every tile from start to goal inclusive, false if there is no path. safe to call from several threads at
+	// once, but not while update runs
+	bool findPath(glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path);
+
+	uint32_t getNodeCount() const { return static_cast<uint32_t>(m_nodes.size() - m_freeNodes.size()); }
+	uint64_t getCacheHits() const { return m_cacheHits.load(std::memory_order_relaxed); }
+	uint64_t getCacheMisses() const { return m_cacheMisses.load(std::memory_order_relaxed); }
+
+	static uint32_t getHeuristic(glm::ivec2 from, glm::ivec2 to);
+	// sum of the step costs, the path must be 8 connected
+	static uint64_t getPathCost(std::span<const glm::ivec2> path);
+
+private:
+	static constexpr uint32_t invalid = UINT32_MAX;
+	// furthest a smoothing shortcut looks ahead along the path, in tiles
+	static constexpr size_t maxSmoothingSpan = TileChunk::size;
+	// walkable runs along a border at least this long get an entrance at each end instead of one in the middle
+	static constexpr int splitEntranceLength = 6;
+	// paths found without the abstract search, inside one chunk or through a cached stretch, are only kept when
+	// they cost at most this percentage of the heuristic, which the shortest path can't beat
+	static constexpr uint64_t maxShortcutCost = 120;
+
+	struct Edge
+	{
+		uint32_t to;
+		uint32_t cost;
+		// tiles after this node up to and including to, as chunk local indices in the cluster's path storage
+		uint32_t pathOffset;
+		uint32_t pathLength;
+	};
+
+	struct Node
+	{
+		glm::ivec2 tile;
+		uint32_t cluster = invalid;
+		uint32_t border = invalid;
+		// the node on the other side of the border, one straight step away
+		uint32_t partner = invalid;
+		// to the other nodes of the same cluster
+		std::vector<Edge> edges;
+	};
+
+	// the stretch of a path between leaving the source chunk and entering the destination chunk, which any
+	// request between the same two chunks can reuse
+	struct CachedPath
+	{
+		uint64_t key;
+		std::vector<glm::ivec2> tiles;
+		// sorted, for invalidation
+		std::vector<uint32_t> chunks;
+	};
+
+	struct ClusterSearch;
+	// two per thread so the start and goal floods of one request can both be kept, concurrent searches never
+	// share scratch
+	static ClusterSearch& getClusterSearch(uint32_t slot = 0);
+
+	void buildMoves(uint32_t cluster);
+	// borders are numbered chunk * 2 for the east edge and chunk * 2 + 1 for the south edge
+	void buildBorder(uint32_t border);
+	void removeBorder(uint32_t border);
+	void addEntrance(uint32_t border, glm::ivec2 tile, glm::ivec2 across);
+	uint32_t allocateNode(glm::ivec2 tile, uint32_t border);
+	void buildClusterEdges(uint32_t cluster);
+
+	// Dijkstra from start over one chunk until every node of the chunk is settled, or A* when goal is given.
+	// leaves the cost and parent of every reached tile in search
+	bool searchCluster(uint32_t cluster, glm::ivec2 start, const glm::ivec2* goal, ClusterSearch& search) const;
+	// appends the tiles from from back along the search's parents, stopping before until
+	void appendParents(const ClusterSearch& search, uint32_t cluster, uint16_t from, uint16_t until, std::vector<glm::ivec2>& path) const;
+	// appends the tiles after start up to and including goal, both inside cluster
+	bool findClusterPath(uint32_t cluster, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path) const;
+	bool findCachedPath(uint32_t startCluster, uint32_t goalCluster, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path);
+	bool findAbstractPath(uint32_t startCluster, uint32_t goalCluster, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path);
+	void storeCachedPath(uint64_t key, std::span<const glm::ivec2> tiles);
+	static bool isShortcutCostOk(std::span<const glm::ivec2> path) { return getPathCost(path) * 100 <= getHeuristic(path.front(), path.back()) * maxShortcutCost; }
+	// replaces detours through entrances with straight lines wherever they are walkable
+	void smoothPath(std::vector<glm::ivec2>& path) const;
+
+	// 8 connected line from from to to, calls step(tile, next) for every step until it returns false
+	template<class Func>
+	static bool walkLine(glm::ivec2 from, glm::ivec2 to, Func&& step);
+
+	const TileMap* m_map = nullptr;
+
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_freeNodes;
+	std::vector<std::vector<uint32_t>> m_clusterNodes;
+	// the tiles of every edge in the cluster, see Edge
+	std::vector<std::vector<uint16_t>> m_clusterPaths;
+	std::vector<std::vector<uint32_t>> m_borderNodes;
+	// per tile, one bit per direction that stays in the chunk and is a legal step, so in-chunk searches never
+	// go through the map
+	std::vector<std::array<uint8_t, TileChunk::tileCount>> m_moves;
+
+	// least recently used path at the back
+	std::mutex m_cacheMutex;
+	size_t m_cacheCapacity = 0;
+	std::list<CachedPath> m_cache;
+	std::unordered_map<uint64_t, std::list<CachedPath>::iterator> m_cacheIndex;
+	std::atomic<uint64_t> m_cacheHits = 0;
+	std::atomic<uint64_t> m_cacheMisses = 0;
+};
+
+template<class Func>
+bool PathFinder::walkLine(glm::ivec2 from, glm::ivec2 to, Func&& step)
+{
+	// bresenham, every step moves one tile along the major axis and one along the minor axis as needed
+	const int dx = std::abs(to.x - from.x);
+	const int dy = std::abs(to.y - from.y);
+	const int stepX = to.x > from.x ? 1 : -1;
+	const int stepY = to.y > from.y ? 1 : -1;
+	const int steps = std::max(dx, dy);
+
+	glm::ivec2 tile = from;
+	int error = 0;
+	for (int i = 0; i < steps; i++)
+	{
+		glm::ivec2 next = tile;
+		if (dx >= dy)
+		{
+			next.x += stepX;
+			error += dy;
+			if (2 * error >= dx)
+			{
+				next.y += stepY;
+				error -= dx;
+			}
+		}
+		else
+		{
+			next.y += stepY;
+			error += dx;
+			if (2 * error >= dy)
+			{
+				next.x += stepX;
+				error -= dy;
+			}
+		}
+
+		if (!step(tile, next))
+			return false;
+		tile = next;
+	}
+	return true;
+}
@@ -0,0 +1,248 @@
+#include "PathRequestQueue.h"
+
+#include <algorithm>
+
+#include "Sim/PathFinder.h"
+#include "Sim/Reachability.h"
+#include "Sim/World.h"
+#include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
+
+PathRequestQueue::~PathRequestQueue()
+{
+	// the workers point into the batch
+	finish();
+}
+
+void PathRequestQueue::create(PathFinder& pathFinder, const Reachability& reachability, std::chrono::microseconds budget)
+{
+	m_pathFinder = &pathFinder;
+	m_reachability = &reachability;
+	m_budget = budget;
+}
+
+void PathRequestQueue::request(Entity requester, glm::ivec2 start, glm::ivec2 goal, Callback callback, PathPriority priority)
+{
+	// the old subscriber, queued or in flight, goes stale with its ticket
+	const uint32_t ticket = ++m_nextTicket;
+	m_requesters[requester] = ticket;
+
+	const uint64_t key = getKey(start, goal);
+	auto it = m_slotIndex.find(key);
+
+	uint32_t slot;
+	if (it != m_slotIndex.end())
+		slot = it->second;
+	else
+	{
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		m_slots[slot] = Request { start, goal, priority, false, false, {} };
+		m_slotIndex.emplace(key, slot);
+	}
+
+	Request& entry = m_slots[slot];
+	entry.subscribers.push_back(Subscriber { requester, ticket, std::move(callback) });
+
+	// a request being solved right now hands its result to the new subscriber too, the raised priority only
+	// matters if it gets deferred
+	if (entry.inFlight)
+		entry.priority = std::max(entry.priority, priority);
+	else if (!entry.queued)
+	{
+		entry.priority = priority;
+		entry.queued = true;
+		m_queues[static_cast<size_t>(priority)].push_back(slot);
+	}
+	else if (priority > entry.priority)
+	{
+		entry.priority = priority;
+		m_queues[static_cast<size_t>(priority)].push_back(slot);
+	}
+}
+
+void PathRequestQueue::cancel(Entity requester)
+{
+	m_requesters.erase(requester);
+}
+
+void PathRequestQueue::collect(const World& world)
+{
+	TRACE_ZONE("PathRequestQueue::collect");
+
+	// delivered on a later tick, the requests stay in flight until then
+	if (isBusy())
+		return;
+
+	m_solvedCount = 0;
+	m_deferredCount = 0;
+	m_rejectedCount = static_cast<uint32_t>(m_unreachable.size());
+
+	// unreached requests go back to the front of their queue, walked backwards so they keep their order
+	for (auto it = m_batch.rbegin(); it != m_batch.rend(); ++it)
+	{
+		Request& entry = m_slots[it->slot];
+		entry.inFlight = false;
+		if (!it->solved)
+		{
+			entry.queued = true;
+			m_queues[static_cast<size_t>(entry.priority)].push_front(it->slot);
+			m_deferredCount++;
+		}
+	}
+
+	for (BatchEntry& batchEntry : m_batch)
+	{
+		if (!batchEntry.solved)
+			continue;
+
+		m_solvedCount++;
+		deliver(world, batchEntry.slot, batchEntry.found, batchEntry.path);
+	}
+
+	for (uint32_t slot : m_unreachable)
+		deliver(world, slot, false, {});
+
+	m_batch.clear();
+	m_unreachable.clear();
+
+	if (m_deferredCount > 0)
+		LOG_DEBUG(LogCategory::Path, "path budget spent, {} requests deferred to the next tick", m_deferredCount);
+}
+
+void PathRequestQueue::dispatch(const World& world)
+{
+	TRACE_ZONE("PathRequestQueue::dispatch");
+
+	// the queues keep filling until the last batch is collected, it may have finished after this tick's collect
+	if (isBusy() || !m_batch.empty() || !m_unreachable.empty())
+		return;
+
+	// highest priority first. stale subscribers are dropped here so nobody searches for a dead colonist
+	for (size_t priority = m_queues.size(); priority-- > 0;)
+	{
+		std::deque<uint32_t>& queue = m_queues[priority];
+		while (!queue.empty())
+		{
+			const uint32_t slot = queue.front();
+			queue.pop_front();
+
+			Request& entry = m_slots[slot];
+			if (!entry.queued || static_cast<size_t>(entry.priority) != priority)
+				continue;
+
+			std::erase_if(entry.subscribers, [&](const Subscriber& subscriber) {
+				if (isCurrent(world, subscriber))
+					return false;
+
+				// a dead requester's ticket would otherwise stay pending forever
+				auto it = m_requesters.find(subscriber.requester);
+				if (it != m_requesters.end() && it->second == subscriber.ticket)
+					m_requesters.erase(it);
+				return true;
+			});
+			entry.queued = false;
+
+			if (entry.subscribers.empty())
+				releaseSlot(slot);
+			else if (!m_reachability->canReach(entry.start, entry.goal))
+			{
+				// the search would flood everything reachable from start before giving up
+				entry.inFlight = true;
+				m_unreachable.push_back(slot);
+			}
+			else
+			{
+				entry.inFlight = true;
+				BatchEntry& batchEntry = m_batch.emplace_back();
+				batchEntry.slot = slot;
+				batchEntry.start = entry.start;
+				batchEntry.goal = entry.goal;
+			}
+		}
+	}
+
+	if (m_batch.empty())
+		return;
+
+	m_nextEntry.store(0, std::memory_order_relaxed);
+	m_stopped.store(false, std::memory_order_relaxed);
+	m_deadline = std::chrono::steady_clock::now() + m_budget;
+
+	// every job pulls requests off the shared index until the batch or the budget runs out. one per worker
+	// besides the main thread, which never picks them up so a batch can't stall the frame's own jobs
+	const uint32_t jobCount = std::min(std::max(2u, JobSystem::GetWorkerCount()) - 1, static_cast<uint32_t>(m_batch.size()));
+	for (uint32_t i = 0; i < jobCount; i++)
+		JobSystem::RunBackground([this] { solveBatch(); }, &m_batchCounter);
+}
+
+void PathRequestQueue::finish()
+{
+	// each worker stops after the search it is on, like when the budget runs out
+	m_stopped.store(true, std::memory_order_relaxed);
+	JobSystem::Wait(m_batchCounter);
+}
+
+uint64_t PathRequestQueue::getKey(glm::ivec2 start, glm::ivec2 goal)
+{
+	return (static_cast<uint64_t>(static_cast<uint16_t>(start.x)) << 48) | (static_cast<uint64_t>(static_cast<uint16_t>(start.y)) << 32) |
+		   (static_cast<uint64_t>(static_cast<uint16_t>(goal.x)) << 16) | static_cast<uint64_t>(static_cast<uint16_t>(goal.y));
+}
+
+bool PathRequestQueue::isCurrent(const World& world, const Subscriber& subscriber) const
+{
+	auto it = m_requesters.find(subscriber.requester);
+	return it != m_requesters.end() && it->second == subscriber.ticket && world.isAlive(subscriber.requester);
+}
+
+void PathRequestQueue::releaseSlot(uint32_t slot)
+{
+	Request& entry = m_slots[slot];
+	m_slotIndex.erase(getKey(entry.start, entry.goal));
+	entry.subscribers.clear();
+	entry.queued = false;
+	entry.inFlight = false;
+	m_freeSlots.push_back(slot);
+}
+
+void PathRequestQueue::deliver(const World& world, uint32_t slot, bool found, std::span<const glm::ivec2> path)
+{
+	// callbacks may issue new requests, which can reuse this slot once it is released
+	std::vector<Subscriber> subscribers = std::move(m_slots[slot].subscribers);
+	releaseSlot(slot);
+
+	for (Subscriber& subscriber : subscribers)
+	{
+		if (!isCurrent(world, subscriber))
+			continue;
+
+		m_requesters.erase(subscriber.requester);
+		subscriber.callback(subscriber.requester, found, path);
+	}
+}
+
+void PathRequestQueue::solveBatch()
+{
+	TRACE_ZONE("PathRequestQueue::solveBatch");
+
+	for (;;)
+	{
+		// the first request is solved whatever the budget, so a busy frame still makes progress
+		const uint32_t index = m_nextEntry.fetch_add(1, std::memory_order_relaxed);
+		if (index >= m_batch.size() || (index > 0 && (m_stopped.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= m_deadline)))
+			return;
+
+		BatchEntry& entry = m_batch[index];
+		entry.found = m_pathFinder->findPath(entry.start, entry.goal, entry.path);
+		entry.solved = true;
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Sim/Entity.h"
+#include "Utils/JobSystem.hpp"
+
+class PathFinder;
+class Reachability;
+class World;
+
+enum class PathPriority : uint8_t
+{
+	Low,
+	Normal,
+	// e.g. fleeing or answering an alarm
+	High,
+	Count
+};
+
+// path requests solved on the job system between ticks. dispatch hands the pending requests to the workers at the
+// end of a tick, they solve them highest priority first while the frame renders and stop taking new ones once the
+// time budget is spent, collect delivers the results at the start of the first tick after the batch finished and
+// puts back whatever wasn't reached. a batch still running is left alone rather than waited for, so catch-up ticks
+// don't stall on it, and no new one starts until it is collected. every requester has at most one request,
+// identical requests share one search, and requests between tiles that can't reach each other fail without a search
+class PathRequestQueue
+{
+public:
+	// found is false when there is no path, path is only valid during the call
+	using Callback = std::function<void(Entity requester, bool found, std::span<const glm::ivec2> path)>;
+
+	PathRequestQueue() = default;
+	~PathRequestQueue();
+	PathRequestQueue(const PathRequestQueue&) = delete;
+	PathRequestQueue& operator=(const PathRequestQueue&) = delete;
+
+	// budget is the wall time the workers may spend per batch, across all of them
+	void create(PathFinder& pathFinder, const Reachability& reachability, std::chrono::microseconds budget = std::chrono::microseconds(2000));
+
+	// replaces the requester's pending request, if any. the callback runs in a later collect on the calling thread
+	void request(Entity requester, glm::ivec2 start, glm::ivec2 goal, Callback callback, PathPriority priority = PathPriority::Normal);
+	// drops the requester's request, including one that is being solved right now
+	void cancel(Entity requester);
+
+	// sim thread only. the map, the path finder and the reachability index may only change while no batch is
+	// running, call finish first
+	void collect(const World& world);
+	void dispatch(const World& world);
+	// stops handing out requests and waits for the searches already started, the rest are deferred
+	void finish();
+	bool isBusy() const { return !m_batchCounter.IsDone(); }
+
+	uint32_t getPendingCount() const { return static_cast<uint32_t>(m_requesters.size()); }
+	// requests solved by the last collected batch, and the ones it ran out of budget for
+	uint32_t getSolvedCount() const { return m_solvedCount; }
+	uint32_t getDeferredCount() const { return m_deferredCount; }
+	// requests the last collect failed without searching
+	uint32_t getRejectedCount() const { return m_rejectedCount; }
+
+private:
+	struct Subscriber
+	{
+		Entity requester;
+		uint32_t ticket;
+		Callback callback;
+	};
+
+	// one per distinct (start, goal)
+	struct Request
+	{
+		glm::ivec2 start;
+		glm::ivec2 goal;
+		PathPriority priority = PathPriority::Normal;
+		bool queued = false;
+		// in the current batch, new subscribers wait for its result
+		bool inFlight = false;
+		std::vector<Subscriber> subscribers;
+	};
+
+	// written by one worker, read by the sim thread once the batch counter is done. start and goal are copied so
+	// workers never look at the slots
+	struct BatchEntry
+	{
+		uint32_t slot = 0;
+		glm::ivec2 start;
+		glm::ivec2 goal;
+		bool solved = false;
+		bool found = false;
+		std::vector<glm::ivec2> path;
+	};
+
+	static uint64_t getKey(glm::ivec2 start, glm::ivec2 goal);
+
+	// false if the subscriber was cancelled, retargeted or its requester died
+	bool isCurrent(const World& world, const Subscriber& subscriber) const;
+	void releaseSlot(uint32_t slot);
+	// calls back the slot's current subscribers and releases it
+	void deliver(const World& world, uint32_t slot, bool found, std::span<const glm::ivec2> path);
+	void solveBatch();
+
+	PathFinder* m_pathFinder = nullptr;
+	const Reachability* m_reachability = nullptr;
+	std::chrono::microseconds m_budget { 0 };
+
+	std::vector<Request> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	std::unordered_map<uint64_t, uint32_t> m_slotIndex;
+	// FIFO per priority, a slot whose priority was raised is skipped in its old queue
+	std::array<std::deque<uint32_t>, static_cast<size_t>(PathPriority::Count)> m_queues;
+
+	// the requester's current ticket, a subscriber with an older one was replaced
+	std::unordered_map<Entity, uint32_t> m_requesters;
+	uint32_t m_nextTicket = 0;
+
+	std::vector<BatchEntry> m_batch;
+	std::atomic<uint32_t> m_nextEntry = 0;
+	// set by finish, the workers stop as if the budget were spent
+	std::atomic<bool> m_stopped = false;
+	std::chrono::steady_clock::time_point m_deadline;
+	JobCounter m_batchCounter;
+	// failed by dispatch, delivered with the batch
+	std::vector<uint32_t> m_unreachable;
+
+	uint32_t m_solvedCount = 0;
+	uint32_t m_deferredCount = 0;
+	uint32_t m_rejectedCount = 0;
+};
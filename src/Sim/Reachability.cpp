@@ -0,0 +1,318 @@
+#include "Reachability.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include "Utils/JobSystem.hpp"
+#include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
+
+void Reachability::create(const TileMap& map)
+{
+	TRACE_ZONE("Reachability::create");
+	const auto start = std::chrono::steady_clock::now();
+
+	m_map = &map;
+
+	const glm::ivec2 chunkCount = map.getChunkCount();
+	const uint32_t count = static_cast<uint32_t>(chunkCount.x * chunkCount.y);
+
+	std::array<uint16_t, TileChunk::tileCount> empty;
+	empty.fill(blocked);
+	m_labels.assign(count, empty);
+	m_regionComponents.assign(count, {});
+	m_chunkQueued.assign(count, 0);
+	m_components.clear();
+	m_componentCount = 0;
+
+	// every chunk counts as changed, with nothing walkable before
+	std::vector<uint32_t> chunks(count);
+	std::iota(chunks.begin(), chunks.end(), 0u);
+	update(chunks);
+
+	LOG_INFO(LogCategory::Path, "{} reachable components over {} chunks in {:.2f}ms", m_componentCount, count,
+			 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+void Reachability::update(std::span<const uint32_t> changedChunks)
+{
+	if (changedChunks.empty())
+		return;
+
+	TRACE_ZONE("Reachability::update");
+
+	const uint32_t count = static_cast<uint32_t>(changedChunks.size());
+	m_oldLabels.resize(count);
+	m_oldRegionComponents.resize(count);
+	std::vector<uint8_t> blockedTiles(count, 0);
+
+	JobSystem::ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const uint32_t chunk = changedChunks[i];
+			m_oldLabels[i] = m_labels[chunk];
+			m_oldRegionComponents[i] = std::move(m_regionComponents[chunk]);
+			blockedTiles[i] = labelChunk(chunk);
+		}
+	});
+
+	// only losing a walkable tile can cut a component in two, anything else just adds tiles and links
+	if (std::ranges::find(blockedTiles, 1) != blockedTiles.end())
+		splitRegions(changedChunks);
+	else
+		mergeRegions(changedChunks);
+}
+
+bool Reachability::labelChunk(uint32_t chunk)
+{
+	const glm::ivec2 origin = m_map->getChunkOrigin(chunk);
+	const int size = static_cast<int>(TileChunk::size);
+
+	std::array<uint16_t, TileChunk::tileCount>& labels = m_labels[chunk];
+	const std::array<uint16_t, TileChunk::tileCount> old = labels;
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+			labels[(y << TileChunk::sizeBits) | x] = m_map->isWalkable({ origin.x + x, origin.y + y }) ? 0 : blocked;
+	}
+
+	// 0 marks walkable tiles no region has reached yet, so regions are numbered from 1 and shifted down after
+	std::array<uint16_t, TileChunk::tileCount> stack;
+	uint16_t regionCount = 0;
+	for (uint32_t seed = 0; seed < TileChunk::tileCount; seed++)
+	{
+		if (labels[seed] != 0)
+			continue;
+
+		const uint16_t region = ++regionCount;
+		uint32_t top = 0;
+		stack[top++] = static_cast<uint16_t>(seed);
+		labels[seed] = region;
+
+		while (top > 0)
+		{
+			const uint32_t local = stack[--top];
+			const uint32_t x = local & (TileChunk::size - 1);
+			const auto visit = [&](uint32_t next) {
+				if (labels[next] == 0)
+				{
+					labels[next] = region;
+					stack[top++] = static_cast<uint16_t>(next);
+				}
+			};
+
+			if (x > 0)
+				visit(local - 1);
+			if (x + 1 < TileChunk::size)
+				visit(local + 1);
+			if (local >= TileChunk::size)
+				visit(local - TileChunk::size);
+			if (local + TileChunk::size < TileChunk::tileCount)
+				visit(local + TileChunk::size);
+		}
+	}
+
+	bool lostTile = false;
+	for (uint32_t local = 0; local < TileChunk::tileCount; local++)
+	{
+		if (labels[local] != blocked)
+			labels[local]--;
+		else if (old[local] != blocked)
+			lostTile = true;
+	}
+
+	m_regionComponents[chunk].assign(regionCount, invalid);
+	return lostTile;
+}
+
+uint32_t Reachability::allocateComponent()
+{
+	const uint32_t component = static_cast<uint32_t>(m_components.size());
+	m_components.push_back(component);
+	m_componentCount++;
+	return component;
+}
+
+uint32_t Reachability::findComponent(uint32_t component)
+{
+	// path halving
+	while (m_components[component] != component)
+	{
+		m_components[component] = m_components[m_components[component]];
+		component = m_components[component];
+	}
+	return component;
+}
+
+void Reachability::unionComponents(uint32_t a, uint32_t b)
+{
+	a = findComponent(a);
+	b = findComponent(b);
+	if (a != b)
+	{
+		m_components[std::max(a, b)] = std::min(a, b);
+		m_componentCount--;
+	}
+}
+
+void Reachability::flatten()
+{
+	for (uint32_t component = 0; component < m_components.size(); component++)
+		m_components[component] = findComponent(component);
+
+	// ids of merged and split components are never reused, so they pile up with every edit. renumbering looks at
+	// every region, which only happens once dead ids outnumber the live ones
+	if (m_components.size() <= static_cast<size_t>(m_componentCount) * 2 + 1024)
+		return;
+
+	std::vector<uint32_t> renumbered(m_components.size(), invalid);
+	uint32_t live = 0;
+	for (std::vector<uint32_t>& regions : m_regionComponents)
+	{
+		for (uint32_t& component : regions)
+		{
+			if (renumbered[m_components[component]] == invalid)
+				renumbered[m_components[component]] = live++;
+			component = renumbered[m_components[component]];
+		}
+	}
+	m_components.resize(live);
+	std::iota(m_components.begin(), m_components.end(), 0u);
+}
+
+void Reachability::mergeRegions(std::span<const uint32_t> chunks)
+{
+	TRACE_ZONE("Reachability::mergeRegions");
+
+	// every old region lies inside one new region, which takes over its component. several old regions in one
+	// new region were joined by the edit
+	for (uint32_t i = 0; i < chunks.size(); i++)
+	{
+		const std::array<uint16_t, TileChunk::tileCount>& labels = m_labels[chunks[i]];
+		std::vector<uint32_t>& regions = m_regionComponents[chunks[i]];
+
+		for (uint32_t local = 0; local < TileChunk::tileCount; local++)
+		{
+			const uint16_t region = labels[local];
+			const uint16_t oldRegion = m_oldLabels[i][local];
+			if (region == blocked || oldRegion == blocked)
+				continue;
+
+			const uint32_t component = m_oldRegionComponents[i][oldRegion];
+			if (regions[region] == invalid)
+				regions[region] = component;
+			else if (regions[region] != component)
+				unionComponents(regions[region], component);
+		}
+
+		// made entirely of tiles that just became walkable
+		for (uint32_t& component : regions)
+		{
+			if (component == invalid)
+				component = allocateComponent();
+		}
+	}
+
+	// links between two changed chunks are seen from both sides, which costs nothing
+	for (uint32_t chunk : chunks)
+	{
+		forEachLink(chunk, [this, chunk](uint16_t region, uint32_t neighbour, uint16_t neighbourRegion) {
+			unionComponents(m_regionComponents[chunk][region], m_regionComponents[neighbour][neighbourRegion]);
+		});
+	}
+
+	flatten();
+}
+
+void Reachability::splitRegions(std::span<const uint32_t> chunks)
+{
+	TRACE_ZONE("Reachability::splitRegions");
+
+	// the components the changed chunks were part of may have come apart, their regions get new ids by flooding
+	// over the links. every other component keeps its id
+	std::vector<uint32_t> affected;
+	for (const std::vector<uint32_t>& regions : m_oldRegionComponents)
+	{
+		for (uint32_t component : regions)
+			affected.push_back(m_components[component]);
+	}
+	std::ranges::sort(affected);
+	affected.erase(std::ranges::unique(affected).begin(), affected.end());
+	m_componentCount -= static_cast<uint32_t>(affected.size());
+
+	// regions of the changed chunks start out invalid, the rest still have their old id until flooded
+	const uint32_t firstNew = static_cast<uint32_t>(m_components.size());
+	const auto isPending = [&](uint32_t chunk, uint16_t region) {
+		const uint32_t component = m_regionComponents[chunk][region];
+		return component == invalid || (component < firstNew && std::ranges::binary_search(affected, m_components[component]));
+	};
+
+	// every piece an affected component fell into touches a changed chunk, so the floods start from the changed
+	// chunks and their neighbours and only ever reach chunks those components cover
+	const glm::ivec2 chunkCount = m_map->getChunkCount();
+	std::vector<uint32_t> seeds;
+	for (uint32_t chunk : chunks)
+	{
+		const int x = static_cast<int>(chunk) % chunkCount.x;
+		const int y = static_cast<int>(chunk) / chunkCount.x;
+		seeds.push_back(chunk);
+		if (x > 0)
+			seeds.push_back(chunk - 1);
+		if (x + 1 < chunkCount.x)
+			seeds.push_back(chunk + 1);
+		if (y > 0)
+			seeds.push_back(chunk - chunkCount.x);
+		if (y + 1 < chunkCount.y)
+			seeds.push_back(chunk + chunkCount.x);
+	}
+
+	// a flood stepping into a region that isn't pending found a component it was cut off from before, that one is
+	// joined once every flood is done. the queue holds chunks, each pop follows the links of every region the
+	// flood has reached in it so far, first in first out so most of a chunk's regions are reached by then
+	std::vector<uint32_t> queue;
+	std::vector<std::pair<uint32_t, uint32_t>> external;
+	for (uint32_t seedChunk : seeds)
+	{
+		for (uint16_t seedRegion = 0; seedRegion < m_regionComponents[seedChunk].size(); seedRegion++)
+		{
+			if (!isPending(seedChunk, seedRegion))
+				continue;
+
+			const uint32_t component = allocateComponent();
+			m_regionComponents[seedChunk][seedRegion] = component;
+			m_chunkQueued[seedChunk] = 1;
+			queue.assign(1, seedChunk);
+
+			for (size_t next = 0; next < queue.size(); next++)
+			{
+				const uint32_t chunk = queue[next];
+				m_chunkQueued[chunk] = 0;
+
+				const std::vector<uint32_t>& regions = m_regionComponents[chunk];
+				forEachLink(chunk, [&](uint16_t region, uint32_t neighbour, uint16_t neighbourRegion) {
+					uint32_t& neighbourComponent = m_regionComponents[neighbour][neighbourRegion];
+					if (regions[region] != component || neighbourComponent == component)
+						return;
+
+					if (isPending(neighbour, neighbourRegion))
+					{
+						neighbourComponent = component;
+						if (!m_chunkQueued[neighbour])
+						{
+							m_chunkQueued[neighbour] = 1;
+							queue.push_back(neighbour);
+						}
+					}
+					else if (neighbourComponent < firstNew)
+						external.emplace_back(component, neighbourComponent);
+				});
+			}
+		}
+	}
+
+	for (auto [component, other] : external)
+		unionComponents(component, other);
+
+	flatten();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Sim/TileMap.h"
+
+// connected component label for every walkable tile, so "can a reach b" is two lookups instead of a failed search
+// that floods everything reachable first. diagonal steps need both straight neighbours walkable, which makes 8
+// connected reachability the same as 4 connected. every chunk labels its own regions, regions are joined into
+// components across chunk borders by union find over component ids. an edit relabels its chunks, then either
+// unions the new regions into what they touch or, when a tile was blocked and a component may have split, floods
+// new ids over the regions of the components it touched, outward from the changed chunks. the tiles of other
+// chunks are never looked at, and only chunks a touched component covers are visited
+class Reachability
+{
+public:
+	static constexpr uint32_t invalid = UINT32_MAX;
+
+	// the map must outlive the index
+	void create(const TileMap& map);
+
+	void update(std::span<const uint32_t> changedChunks);
+
+	// invalid for tiles that aren't walkable, otherwise equal for exactly the tiles that reach each other.
+	// ids change across updates
+	uint32_t getComponent(glm::ivec2 tile) const
+	{
+		if (!m_map->isInBounds(tile))
+			return invalid;
+
+		const uint32_t chunk = m_map->getChunkIndex(tile);
+		const uint16_t region = m_labels[chunk][TileMap::getLocalIndex(tile)];
+		return region == blocked ? invalid : m_components[m_regionComponents[chunk][region]];
+	}
+
+	// false if either tile isn't walkable
+	bool canReach(glm::ivec2 from, glm::ivec2 to) const
+	{
+		const uint32_t component = getComponent(from);
+		return component != invalid && component == getComponent(to);
+	}
+
+	uint32_t getComponentCount() const { return m_componentCount; }
+
+private:
+	static constexpr uint16_t blocked = UINT16_MAX;
+
+	// regions of one chunk, written into m_labels[chunk]. true if a tile that was walkable no longer is
+	bool labelChunk(uint32_t chunk);
+	// func(uint16_t region, uint32_t neighbourChunk, uint16_t neighbourRegion) for every pair of walkable tiles
+	// facing each other across the chunk's four borders
+	template<class Func>
+	void forEachLink(uint32_t chunk, Func&& func) const;
+
+	uint32_t allocateComponent();
+	uint32_t findComponent(uint32_t component);
+	void unionComponents(uint32_t a, uint32_t b);
+	// points every id straight at its root, and renumbers when dead ids outnumber the live ones. allocate and
+	// union keep the component count
+	void flatten();
+
+	void mergeRegions(std::span<const uint32_t> chunks);
+	void splitRegions(std::span<const uint32_t> chunks);
+
+	const TileMap* m_map = nullptr;
+
+	// per tile region inside its chunk, blocked if not walkable
+	std::vector<std::array<uint16_t, TileChunk::tileCount>> m_labels;
+	// per chunk, the component id of every region
+	std::vector<std::vector<uint32_t>> m_regionComponents;
+	// union find parent of every component id, every entry is a root between updates
+	std::vector<uint32_t> m_components;
+	uint32_t m_componentCount = 0;
+
+	// the labels and region components the changed chunks had before update relabeled them
+	std::vector<std::array<uint16_t, TileChunk::tileCount>> m_oldLabels;
+	std::vector<std::vector<uint32_t>> m_oldRegionComponents;
+	// per chunk, in the queue of a split's flood. all clear between updates
+	std::vector<uint8_t> m_chunkQueued;
+};
+
+template<class Func>
+void Reachability::forEachLink(uint32_t chunk, Func&& func) const
+{
+	const glm::ivec2 chunkCount = m_map->getChunkCount();
+	const uint32_t x = chunk % chunkCount.x;
+	const uint32_t y = chunk / chunkCount.x;
+	const uint32_t last = TileChunk::size - 1;
+	const auto& labels = m_labels[chunk];
+
+	// step is the local index offset along the border, inside and outside the first tile on each side
+	const auto link = [&](uint32_t neighbour, uint32_t inside, uint32_t outside, uint32_t step) {
+		const auto& neighbourLabels = m_labels[neighbour];
+		for (uint32_t i = 0; i < TileChunk::size; i++)
+		{
+			const uint16_t region = labels[inside + i * step];
+			const uint16_t neighbourRegion = neighbourLabels[outside + i * step];
+			if (region != blocked && neighbourRegion != blocked)
+				func(region, neighbour, neighbourRegion);
+		}
+	};
+
+	if (x > 0)
+		link(chunk - 1, 0, last, TileChunk::size);
+	if (x + 1 < static_cast<uint32_t>(chunkCount.x))
+		link(chunk + 1, last, 0, TileChunk::size);
+	if (y > 0)
+		link(chunk - chunkCount.x, 0, last << TileChunk::sizeBits, 1);
+	if (y + 1 < static_cast<uint32_t>(chunkCount.y))
+		link(chunk + chunkCount.x, last << TileChunk::sizeBits, 0, 1);
+}
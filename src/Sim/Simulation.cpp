@@ -0,0 +1,141 @@
+#include "Simulation.h"
+
+#include <chrono>
+
+#include "Renderer/SpriteBatch.h"
+#include "Utils/Logging.hpp"
+#include "Utils/Time.hpp"
+#include "Utils/Trace.hpp"
+
+void Simulation::create(uint32_t seed)
+{
+	m_random.seed(seed);
+	m_spatialGrid.create(m_boundsMin, m_boundsMax - m_boundsMin, spatialCellSize);
+
+	m_tileMap.create(mapSize, mapSize, Terrain::Grass);
+	generateTerrain();
+	m_pathFinder.create(m_tileMap);
+	m_reachability.create(m_tileMap);
+	m_flowFields.create(m_tileMap);
+	m_pathRequests.create(m_pathFinder, m_reachability);
+
+	// everything built above starts from the generated map, only later edits go through the journal
+	m_tileMap.setJournal(&m_tileJournal);
+	m_tileJournal.subscribe([this](const TileChangeSet& changes) {
+		// the path workers read both while they search
+		if (!changes.walkabilityChunks.empty())
+			m_pathRequests.finish();
+		m_pathFinder.update(changes.walkabilityChunks);
+		m_reachability.update(changes.walkabilityChunks);
+		m_flowFields.update(changes.walkabilityChunks);
+	});
+	m_tileJournal.subscribe([this](const TileChangeSet& changes) { m_unsavedTiles.add(changes); });
+}
+
+void Simulation::spawnColonists(uint32_t count)
+{
+	std::uniform_real_distribution<float> position(-0.95f, 0.95f);
+	std::uniform_real_distribution<float> velocity(-0.2f, 0.2f);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		m_world.create(Position { { position(m_random), position(m_random) } },
+					   Velocity { { velocity(m_random), velocity(m_random) } },
+					   Sprite { 0, 0xff40c0ff, 2 },
+					   Colonist {});
+	}
+
+	LOG_INFO(LogCategory::Sim, "spawned {} colonists, {} entities", count, m_world.getEntityCount());
+}
+
+void Simulation::tick()
+{
+	TRACE_ZONE("Simulation::tick");
+
+	m_pathRequests.collect(m_world);
+	moveSystem(std::chrono::duration<float>(Time::TickLength).count());
+	m_spatialGrid.sync(m_world, m_positions);
+
+	// tile edits made during the tick reach the derived structures before the next one
+	m_tileJournal.publish(m_tickCount);
+	m_tileMap.clearDirty();
+
+	// searched while the frame renders
+	m_pathRequests.dispatch(m_world);
+	m_tickCount++;
+}
+
+void Simulation::syncSprites(SpriteBatch& batch)
+{
+	TRACE_ZONE("Simulation::syncSprites");
+
+	batch.clear();
+	m_sprites.forEachChunk([&batch](uint32_t count, const Entity*, const Position* positions, const Sprite* sprites) {
+		for (uint32_t i = 0; i < count; i++)
+		{
+			SpriteInstance instance;
+			instance.position = positions[i].value;
+			instance.atlasIndex = sprites[i].atlasIndex;
+			instance.tint = sprites[i].tint;
+			instance.layer = sprites[i].layer;
+			batch.add(instance);
+		}
+	});
+}
+
+void Simulation::generateTerrain()
+{
+	const int size = static_cast<int>(mapSize);
+	std::uniform_int_distribution<int> coordinate(0, size - 1);
+	std::uniform_int_distribution<int> radius(2, 8);
+
+	for (uint32_t blob = 0; blob < mapSize / 4; blob++)
+	{
+		const glm::ivec2 center = { coordinate(m_random), coordinate(m_random) };
+		const int r = radius(m_random);
+		const Terrain inner = blob % 3 == 0 ? Terrain::DeepWater : Terrain::Rock;
+		const Terrain outer = blob % 3 == 0 ? Terrain::ShallowWater : Terrain::Gravel;
+
+		for (int y = center.y - r - 1; y <= center.y + r + 1; y++)
+		{
+			for (int x = center.x - r - 1; x <= center.x + r + 1; x++)
+			{
+				const glm::ivec2 tile = { x, y };
+				const int distanceSquared = (x - center.x) * (x - center.x) + (y - center.y) * (y - center.y);
+				if (!m_tileMap.isInBounds(tile) || distanceSquared > (r + 1) * (r + 1))
+					continue;
+
+				if (distanceSquared <= r * r)
+					m_tileMap.setTerrain(tile, inner);
+				else if (m_tileMap.getTerrain(tile) == Terrain::Grass)
+					m_tileMap.setTerrain(tile, outer);
+			}
+		}
+	}
+
+	// consumers build their first state from the whole map, not from the generator's edits
+	m_tileMap.clearDirty();
+}
+
+void Simulation::moveSystem(float tickSeconds)
+{
+	const glm::vec2 boundsMin = m_boundsMin;
+	const glm::vec2 boundsMax = m_boundsMax;
+
+	// a chunk holds a few hundred movers, plenty of work per job
+	m_moving.forEachChunkParallel([=](uint32_t count, const Entity*, Position* positions, Velocity* velocities) {
+		for (uint32_t i = 0; i < count; i++)
+		{
+			glm::vec2& position = positions[i].value;
+			glm::vec2& velocity = velocities[i].value;
+			position += velocity * tickSeconds;
+
+			// bounce off the edges
+			for (int axis = 0; axis < 2; axis++)
+			{
+				if ((position[axis] < boundsMin[axis] && velocity[axis] < 0.f) || (position[axis] > boundsMax[axis] && velocity[axis] > 0.f))
+					velocity[axis] = -velocity[axis];
+			}
+		}
+	});
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include <glm/vec2.hpp>
+
+#include "Sim/Components.h"
+#include "Sim/FlowField.h"
+#include "Sim/PathFinder.h"
+#include "Sim/PathRequestQueue.h"
+#include "Sim/Reachability.h"
+#include "Sim/SpatialGrid.h"
+#include "Sim/TileJournal.h"
+#include "Sim/TileMap.h"
+#include "Sim/World.h"
+
+class SpriteBatch;
+
+// owns the entity world and steps the sim systems, one call to tick per Time::ConsumeTick
+class Simulation
+{
+public:
+	void create(uint32_t seed = 0);
+
+	// colonists wander inside bounds, in the renderer's clip space for now
+	void spawnColonists(uint32_t count);
+
+	void tick();
+
+	// rebuilds the sprite batch from every entity with a Position and a Sprite, once per rendered frame
+	void syncSprites(SpriteBatch& batch);
+
+	World& getWorld() { return m_world; }
+	// for editing, the path workers read the map while they search so their batch is stopped first. don't keep the
+	// reference past the call
+	TileMap& getTileMap()
+	{
+		m_pathRequests.finish();
+		return m_tileMap;
+	}
+	const TileMap& getTileMap() const { return m_tileMap; }
+	// published at the end of every tick, subscribe to react to tile edits
+	TileJournal& getTileJournal() { return m_tileJournal; }
+	// tile edits since the last clear, for autosaves to write just what changed
+	TileDelta& getUnsavedTiles() { return m_unsavedTiles; }
+	PathFinder& getPathFinder() { return m_pathFinder; }
+	const Reachability& getReachability() const { return m_reachability; }
+	// for many movers heading to the same tile, one field instead of a path each
+	FlowFieldCache& getFlowFields() { return m_flowFields; }
+	// results arrive at the start of the first tick after their batch finished, usually the next one
+	PathRequestQueue& getPathRequests() { return m_pathRequests; }
+	// every entity with a Position, as of the end of the last tick
+	const SpatialGrid& getSpatialGrid() const { return m_spatialGrid; }
+	uint64_t getTickCount() const { return m_tickCount; }
+
+private:
+	// grass with scattered rock outcrops and ponds
+	void generateTerrain();
+	void moveSystem(float tickSeconds);
+
+	static constexpr uint32_t mapSize = 256;
+
+	World m_world;
+	// the journal outlives the map that records into it
+	TileJournal m_tileJournal;
+	TileMap m_tileMap;
+	TileDelta m_unsavedTiles;
+	PathFinder m_pathFinder;
+	Reachability m_reachability;
+	FlowFieldCache m_flowFields;
+	// after the path finder and reachability, its batch must be finished before they go
+	PathRequestQueue m_pathRequests;
+	std::mt19937 m_random;
+	uint64_t m_tickCount = 0;
+
+	glm::vec2 m_boundsMin = { -1.f, -1.f };
+	glm::vec2 m_boundsMax = { 1.f, 1.f };
+
+	// about a tile in clip space, until the sim has world coordinates of its own
+	static constexpr float spatialCellSize = 1.f / 32.f;
+	SpatialGrid m_spatialGrid;
+
+	Query<Position, Velocity> m_moving { m_world };
+	Query<const Position, const Sprite> m_sprites { m_world };
+	Query<const Position> m_positions { m_world };
+};
@@ -0,0 +1,146 @@
+#include "SpatialGrid.h"
+
+#include <cmath>
+
+#include "Utils/JobSystem.hpp"
+#include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
+
+void SpatialGrid::create(glm::vec2 origin, glm::vec2 size, float cellSize)
+{
+	m_origin = origin;
+	m_cellSize = cellSize;
+	m_inverseCellSize = 1.f / cellSize;
+	m_cellCount = { std::max(1, static_cast<int>(std::ceil(size.x * m_inverseCellSize))),
+					std::max(1, static_cast<int>(std::ceil(size.y * m_inverseCellSize))) };
+
+	m_cells.assign(static_cast<size_t>(m_cellCount.x) * m_cellCount.y, invalid);
+	m_items.clear();
+	m_count = 0;
+
+	LOG_DEBUG(LogCategory::Sim, "spatial grid of {}x{} cells", m_cellCount.x, m_cellCount.y);
+}
+
+void SpatialGrid::insert(Entity entity, glm::vec2 position)
+{
+	update(entity, position);
+}
+
+void SpatialGrid::update(Entity entity, glm::vec2 position)
+{
+	if (entity.index >= m_items.size())
+		m_items.resize(entity.index + 1);
+
+	Item& item = m_items[entity.index];
+	const uint32_t cell = getCellIndex(getCellCoords(position));
+
+	// a different entity here is a destroyed one whose slot was reused
+	if (item.cell != invalid && (item.cell != cell || item.entity != entity))
+		unlink(entity.index);
+
+	item.entity = entity;
+	item.position = position;
+	if (item.cell == invalid)
+		link(entity.index, cell);
+}
+
+void SpatialGrid::remove(Entity entity)
+{
+	if (contains(entity))
+		unlink(entity.index);
+}
+
+bool SpatialGrid::contains(Entity entity) const
+{
+	return entity.index < m_items.size() && m_items[entity.index].cell != invalid && m_items[entity.index].entity == entity;
+}
+
+void SpatialGrid::sync(World& world, Query<const Position>& positions)
+{
+	TRACE_ZONE("SpatialGrid::sync");
+
+	if (m_items.size() < world.getSlotCount())
+		m_items.resize(world.getSlotCount());
+
+	m_syncEpoch++;
+	m_moves.resize(JobSystem::GetWorkerCount() + 1);
+
+	// every entity appears once, so each job only writes the items of its own rows. entities staying in their
+	// cell (nearly all of them in a tick) are done here
+	positions.forEachChunkParallel([this](uint32_t count, const Entity* entities, const Position* positions) {
+		const uint32_t worker = JobSystem::GetWorkerIndex();
+		std::vector<Move>& moves = m_moves[worker == JobSystem::InvalidWorker ? m_moves.size() - 1 : worker];
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Item& item = m_items[entities[i].index];
+			const uint32_t cell = getCellIndex(getCellCoords(positions[i].value));
+			item.syncEpoch = m_syncEpoch;
+
+			if (item.cell == cell && item.entity == entities[i])
+				item.position = positions[i].value;
+			else
+				moves.push_back(Move { entities[i], positions[i].value, cell });
+		}
+	});
+
+	// relinking touches neighbouring items, so it stays on this thread
+	for (std::vector<Move>& moves : m_moves)
+	{
+		for (const Move& move : moves)
+		{
+			Item& item = m_items[move.entity.index];
+			if (item.cell != invalid)
+				unlink(move.entity.index);
+
+			item.entity = move.entity;
+			item.position = move.position;
+			link(move.entity.index, move.cell);
+		}
+		moves.clear();
+	}
+
+	for (uint32_t index = 0; index < m_items.size(); index++)
+	{
+		if (m_items[index].cell != invalid && m_items[index].syncEpoch != m_syncEpoch)
+			unlink(index);
+	}
+}
+
+glm::ivec2 SpatialGrid::getCellCoords(glm::vec2 position) const
+{
+	const glm::vec2 local = (position - m_origin) * m_inverseCellSize;
+	return { std::clamp(static_cast<int>(std::floor(local.x)), 0, m_cellCount.x - 1),
+			 std::clamp(static_cast<int>(std::floor(local.y)), 0, m_cellCount.y - 1) };
+}
+
+void SpatialGrid::link(uint32_t index, uint32_t cell)
+{
+	Item& item = m_items[index];
+	item.cell = cell;
+	item.prev = invalid;
+	item.next = m_cells[cell];
+
+	if (item.next != invalid)
+		m_items[item.next].prev = index;
+	m_cells[cell] = index;
+	m_count++;
+}
+
+void SpatialGrid::unlink(uint32_t index)
+{
+	Item& item = m_items[index];
+
+	if (item.prev != invalid)
+		m_items[item.prev].next = item.next;
+	else
+		m_cells[item.cell] = item.next;
+
+	if (item.next != invalid)
+		m_items[item.next].prev = item.prev;
+
+	item.cell = invalid;
+	item.prev = invalid;
+	item.next = invalid;
+	m_count--;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "Sim/Components.h"
+#include "Sim/Entity.h"
+#include "Sim/World.h"
+
+struct Neighbor
+{
+	Entity entity;
+	glm::vec2 position;
+	float distanceSquared = 0.f;
+};
+
+// uniform grid over a fixed rectangle, each cell heads an intrusive list of the entities inside it so moving an
+// entity between cells is O(1). positions outside the rectangle are clamped into the edge cells, queries stay
+// correct out there but get slower. a query only visits the cells it overlaps, so its cost depends on the local
+// density rather than the population
+class SpatialGrid
+{
+public:
+	// cellSize should be about the radius of a typical query, too small and queries walk many empty cells
+	void create(glm::vec2 origin, glm::vec2 size, float cellSize);
+
+	// update inserts entities it doesn't know yet
+	void insert(Entity entity, glm::vec2 position);
+	void update(Entity entity, glm::vec2 position);
+	void remove(Entity entity);
+	bool contains(Entity entity) const;
+
+	// brings the grid in line with every entity positions matches, entities it no longer matches are removed.
+	// cells are recomputed across the job system and only entities that changed cell are relinked
+	void sync(World& world, Query<const Position>& positions);
+
+	// func(Entity entity, glm::vec2 position) for every entity inside the box or circle, in no particular order
+	template<class Func>
+	void forEachInAabb(glm::vec2 min, glm::vec2 max, Func&& func) const;
+	template<class Func>
+	void forEachInRadius(glm::vec2 center, float radius, Func&& func) const;
+
+	// up to k entities within maxRadius that pass filter(Entity), nearest first with ties broken by entity index
+	template<class Filter>
+	void findNearest(glm::vec2 center, uint32_t k, float maxRadius, std::vector<Neighbor>& out, Filter&& filter) const;
+	void findNearest(glm::vec2 center, uint32_t k, float maxRadius, std::vector<Neighbor>& out) const
+	{
+		findNearest(center, k, maxRadius, out, [](Entity) { return true; });
+	}
+
+	uint32_t getCount() const { return m_count; }
+	glm::ivec2 getCellCount() const { return m_cellCount; }
+	float getCellSize() const { return m_cellSize; }
+
+private:
+	static constexpr uint32_t invalid = UINT32_MAX;
+
+	// indexed by Entity::index
+	struct Item
+	{
+		Entity entity;
+		glm::vec2 position;
+		uint32_t cell = invalid;
+		uint32_t prev = invalid;
+		uint32_t next = invalid;
+		uint32_t syncEpoch = 0;
+	};
+
+	// an entity sync found in a different cell, or not in the grid at all
+	struct Move
+	{
+		Entity entity;
+		glm::vec2 position;
+		uint32_t cell;
+	};
+
+	glm::ivec2 getCellCoords(glm::vec2 position) const;
+	uint32_t getCellIndex(glm::ivec2 coords) const { return static_cast<uint32_t>(coords.y) * m_cellCount.x + coords.x; }
+	void link(uint32_t index, uint32_t cell);
+	void unlink(uint32_t index);
+
+	// func(const Item&) for every item in the cells between min and max inclusive
+	template<class Func>
+	void forEachInCells(glm::ivec2 min, glm::ivec2 max, Func&& func) const;
+
+	glm::vec2 m_origin = { 0.f, 0.f };
+	float m_cellSize = 1.f;
+	float m_inverseCellSize = 1.f;
+	glm::ivec2 m_cellCount = { 0, 0 };
+
+	// first item of each cell
+	std::vector<uint32_t> m_cells;
+	std::vector<Item> m_items;
+	uint32_t m_count = 0;
+
+	uint32_t m_syncEpoch = 0;
+	// one list per job worker plus one for other threads, so sync can collect moves without locking
+	std::vector<std::vector<Move>> m_moves;
+};
+
+template<class Func>
+void SpatialGrid::forEachInCells(glm::ivec2 min, glm::ivec2 max, Func&& func) const
+{
+	for (int y = min.y; y <= max.y; y++)
+	{
+		for (int x = min.x; x <= max.x; x++)
+		{
+			for (uint32_t index = m_cells[getCellIndex({ x, y })]; index != invalid; index = m_items[index].next)
+				func(m_items[index]);
+		}
+	}
+}
+
+template<class Func>
+void SpatialGrid::forEachInAabb(glm::vec2 min, glm::vec2 max, Func&& func) const
+{
+	forEachInCells(getCellCoords(min), getCellCoords(max), [&](const Item& item) {
+		if (item.position.x >= min.x && item.position.y >= min.y && item.position.x <= max.x && item.position.y <= max.y)
+			func(item.entity, item.position);
+	});
+}
+
+template<class Func>
+void SpatialGrid::forEachInRadius(glm::vec2 center, float radius, Func&& func) const
+{
+	const float radiusSquared = radius * radius;
+	const glm::vec2 extent = { radius, radius };
+
+	forEachInCells(getCellCoords(center - extent), getCellCoords(center + extent), [&](const Item& item) {
+		const glm::vec2 offset = item.position - center;
+		if (offset.x * offset.x + offset.y * offset.y <= radiusSquared)
+			func(item.entity, item.position);
+	});
+}
+
+template<class Filter>
+void SpatialGrid::findNearest(glm::vec2 center, uint32_t k, float maxRadius, std::vector<Neighbor>& out, Filter&& filter) const
+{
+	out.clear();
+	if (k == 0 || m_cells.empty())
+		return;
+
+	// max heap on distance, the root is the furthest of the best k so far
+	const auto closer = [](const Neighbor& a, const Neighbor& b) {
+		return a.distanceSquared < b.distanceSquared || (a.distanceSquared == b.distanceSquared && a.entity.index < b.entity.index);
+	};
+	const float maxRadiusSquared = maxRadius * maxRadius;
+
+	const auto visit = [&](const Item& item) {
+		const glm::vec2 offset = item.position - center;
+		const Neighbor neighbor { item.entity, item.position, offset.x * offset.x + offset.y * offset.y };
+		if (neighbor.distanceSquared > maxRadiusSquared || (out.size() == k && !closer(neighbor, out.front())) || !filter(item.entity))
+			return;
+
+		if (out.size() == k)
+		{
+			std::pop_heap(out.begin(), out.end(), closer);
+			out.pop_back();
+		}
+		out.push_back(neighbor);
+		std::push_heap(out.begin(), out.end(), closer);
+	};
+
+	// grow square rings of cells around the center until nothing in the next ring can beat the current best
+	const glm::ivec2 centerCell = getCellCoords(center);
+	const int maxRing = std::max(m_cellCount.x, m_cellCount.y);
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		// every cell in this ring is at least ring - 1 cells away from the center
+		const float ringDistance = static_cast<float>(std::max(0, ring - 1)) * m_cellSize;
+		if (ringDistance * ringDistance > maxRadiusSquared || (out.size() == k && ringDistance * ringDistance > out.front().distanceSquared))
+			break;
+
+		const glm::ivec2 min = { std::max(0, centerCell.x - ring), std::max(0, centerCell.y - ring) };
+		const glm::ivec2 max = { std::min(m_cellCount.x - 1, centerCell.x + ring), std::min(m_cellCount.y - 1, centerCell.y + ring) };
+		for (int y = min.y; y <= max.y; y++)
+		{
+			// inner rows only hold the two cells on the ring's edges
+			const bool edgeRow = y == centerCell.y - ring || y == centerCell.y + ring;
+			const int step = edgeRow ? 1 : std::max(1, 2 * ring);
+			for (int x = edgeRow ? min.x : centerCell.x - ring; x <= max.x; x += step)
+			{
+				if (x < min.x)
+					continue;
+
+				for (uint32_t index = m_cells[getCellIndex({ x, y })]; index != invalid; index = m_items[index].next)
+					visit(m_items[index]);
+			}
+		}
+	}
+
+	std::sort_heap(out.begin(), out.end(), closer);
+}
@@ -0,0 +1,95 @@
+#include "TileJournal.h"
+
+#include <algorithm>
+
+#include "Utils/Trace.hpp"
+
+uint32_t TileJournal::subscribe(Subscriber subscriber)
+{
+	const uint32_t id = m_nextId++;
+	m_subscribers.emplace_back(id, std::move(subscriber));
+	return id;
+}
+
+void TileJournal::unsubscribe(uint32_t id)
+{
+	std::erase_if(m_subscribers, [id](const auto& subscriber) { return subscriber.first == id; });
+}
+
+void TileJournal::publish(uint64_t tick)
+{
+	if (m_entries.empty())
+		return;
+
+	TRACE_ZONE("TileJournal::publish");
+
+	// stable, so every tile's edits stay in the order they were made
+	std::ranges::stable_sort(m_entries, [](const TileChange& a, const TileChange& b) {
+		return a.chunk < b.chunk || (a.chunk == b.chunk && a.tile < b.tile);
+	});
+
+	m_changes.clear();
+	m_chunks.clear();
+	m_walkabilityChunks.clear();
+
+	for (size_t first = 0; first < m_entries.size();)
+	{
+		size_t last = first;
+		while (last + 1 < m_entries.size() && m_entries[last + 1].chunk == m_entries[first].chunk && m_entries[last + 1].tile == m_entries[first].tile)
+			last++;
+
+		const TileChange change = { m_entries[first].chunk, m_entries[first].tile, m_entries[first].before, m_entries[last].after };
+		first = last + 1;
+
+		if (change.before == change.after)
+			continue;
+
+		m_changes.push_back(change);
+		if (m_chunks.empty() || m_chunks.back() != change.chunk)
+			m_chunks.push_back(change.chunk);
+		if (change.before.isWalkable() != change.after.isWalkable() && (m_walkabilityChunks.empty() || m_walkabilityChunks.back() != change.chunk))
+			m_walkabilityChunks.push_back(change.chunk);
+	}
+
+	m_entries.clear();
+	if (m_changes.empty())
+		return;
+
+	const TileChangeSet changes = { tick, m_changes, m_chunks, m_walkabilityChunks };
+	for (const auto& [id, subscriber] : m_subscribers)
+		subscriber(changes);
+}
+
+void TileDelta::add(const TileChangeSet& changes)
+{
+	for (const TileChange& change : changes.changes)
+	{
+		auto [it, inserted] = m_index.try_emplace(getKey(change.chunk, change.tile), static_cast<uint32_t>(m_changes.size()));
+		if (inserted)
+		{
+			m_changes.push_back(change);
+			continue;
+		}
+
+		TileChange& existing = m_changes[it->second];
+		existing.after = change.after;
+		if (existing.before != existing.after)
+			continue;
+
+		// changed back, the last change takes its place
+		const uint32_t index = it->second;
+		m_index.erase(it);
+		if (index + 1 != m_changes.size())
+		{
+			m_changes[index] = m_changes.back();
+			m_index[getKey(m_changes[index].chunk, m_changes[index].tile)] = index;
+		}
+		m_changes.pop_back();
+	}
+}
+
+void TileDelta::clear()
+{
+	m_changes.clear();
+	m_index.clear();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Sim/TileMap.h"
+
+// one tile going from before to after, tile is the index inside the chunk (see TileMap::getLocalIndex)
+struct TileChange
+{
+	uint32_t chunk;
+	uint16_t tile;
+	TileState before;
+	TileState after;
+};
+
+// a tick's changes, one per tile that ended the tick different from how it started, sorted by chunk and tile
+struct TileChangeSet
+{
+	uint64_t tick = 0;
+	std::span<const TileChange> changes;
+	// every chunk with a change, sorted
+	std::span<const uint32_t> chunks;
+	// the chunks where a tile became walkable or stopped being, the only ones movement structures care about
+	std::span<const uint32_t> walkabilityChunks;
+};
+
+// every tile edit of a tick, handed to the systems derived from the map once the tick is over. edits are recorded
+// as they happen and coalesced on publish, so a wall built and torn down again in one tick is never seen and a
+// tile painted three times shows up once. subscribers run in the order they subscribed, each doing just the work
+// its changed region needs
+class TileJournal
+{
+public:
+	using Subscriber = std::function<void(const TileChangeSet& changes)>;
+
+	// returns an id for unsubscribe
+	uint32_t subscribe(Subscriber subscriber);
+	void unsubscribe(uint32_t id);
+
+	// called by TileMap for every change it makes
+	void record(uint32_t chunk, uint16_t tile, const TileState& before, const TileState& after)
+	{
+		m_entries.push_back(TileChange { chunk, tile, before, after });
+	}
+
+	// coalesces everything recorded since the last publish and calls every subscriber, nothing is called if no
+	// tile ended up different. subscribers must not edit the map
+	void publish(uint64_t tick);
+
+	// raw edits waiting for the next publish
+	size_t getPendingCount() const { return m_entries.size(); }
+
+private:
+	std::vector<TileChange> m_entries;
+
+	// the last published set, kept to reuse the allocations
+	std::vector<TileChange> m_changes;
+	std::vector<uint32_t> m_chunks;
+	std::vector<uint32_t> m_walkabilityChunks;
+
+	std::vector<std::pair<uint32_t, Subscriber>> m_subscribers;
+	uint32_t m_nextId = 0;
+};
+
+// change sets merged into one change per tile, e.g. the edits an autosave still has to write. a tile that is back
+// where it was when the delta was last cleared drops out
+class TileDelta
+{
+public:
+	void add(const TileChangeSet& changes);
+	void clear();
+
+	// in no particular order
+	std::span<const TileChange> getChanges() const { return m_changes; }
+	bool isEmpty() const { return m_changes.empty(); }
+
+private:
+	static uint64_t getKey(uint32_t chunk, uint16_t tile) { return (static_cast<uint64_t>(chunk) << 16) | tile; }
+
+	std::vector<TileChange> m_changes;
+	std::unordered_map<uint64_t, uint32_t> m_index;
+};
@@ -0,0 +1,107 @@
+#include "TileMap.h"
+
+#include "Sim/TileJournal.h"
+#include "Utils/Logging.hpp"
+
+void TileMap::create(uint32_t width, uint32_t height, Terrain fill)
+{
+	m_chunkCount = { static_cast<int>((width + TileChunk::size - 1) / TileChunk::size),
+					 static_cast<int>((height + TileChunk::size - 1) / TileChunk::size) };
+
+	m_chunks.assign(static_cast<size_t>(m_chunkCount.x) * m_chunkCount.y, TileChunk {});
+	for (TileChunk& chunk : m_chunks)
+		chunk.terrain.fill(static_cast<uint32_t>(fill));
+
+	m_version = 0;
+	m_dirtyChunks.clear();
+
+	LOG_INFO(LogCategory::Sim, "tile map {}x{} in {}x{} chunks, {} KB", getWidth(), getHeight(), m_chunkCount.x, m_chunkCount.y,
+			 getMemoryUsage() / 1024);
+}
+
+TileState TileMap::getState(glm::ivec2 tile) const
+{
+	const TileChunk& chunk = getChunk(tile);
+	const uint32_t local = getLocalIndex(tile);
+	return TileState { static_cast<Terrain>(chunk.terrain.get(local)), static_cast<uint8_t>(chunk.flags.get(local)), chunk.room[local] };
+}
+
+void TileMap::setTerrain(glm::ivec2 tile, Terrain terrain)
+{
+	const TileState before = getState(tile);
+	if (before.terrain == terrain)
+		return;
+
+	markDirty(tile, TileLayer::Terrain).terrain.set(getLocalIndex(tile), static_cast<uint32_t>(terrain));
+	record(tile, before);
+}
+
+void TileMap::setFlags(glm::ivec2 tile, uint8_t flags)
+{
+	// only the 4 bits TileFlag uses are stored, a higher one would never compare equal to what reads back and
+	// dirty the chunk on every call
+	flags &= 0xF;
+	const TileState before = getState(tile);
+	if (before.flags == flags)
+		return;
+
+	markDirty(tile, TileLayer::Flags).flags.set(getLocalIndex(tile), flags);
+	record(tile, before);
+}
+
+void TileMap::setFlag(glm::ivec2 tile, TileFlag flag, bool value)
+{
+	const uint8_t flags = getFlags(tile);
+	setFlags(tile, value ? flags | static_cast<uint8_t>(flag) : flags & ~static_cast<uint8_t>(flag));
+}
+
+void TileMap::setRoom(glm::ivec2 tile, uint16_t room)
+{
+	const TileState before = getState(tile);
+	if (before.room == room)
+		return;
+
+	markDirty(tile, TileLayer::Room).room[getLocalIndex(tile)] = room;
+	record(tile, before);
+}
+
+bool TileMap::isWalkable(glm::ivec2 tile) const
+{
+	if (!isInBounds(tile))
+		return false;
+
+	// the room layer doesn't matter, so it isn't read
+	const TileChunk& chunk = getChunk(tile);
+	const uint32_t local = getLocalIndex(tile);
+	return TileState { static_cast<Terrain>(chunk.terrain.get(local)), static_cast<uint8_t>(chunk.flags.get(local)), 0 }.isWalkable();
+}
+
+void TileMap::clearDirty()
+{
+	for (uint32_t chunkIndex : m_dirtyChunks)
+	{
+		m_chunks[chunkIndex].dirtyLayers = 0;
+		m_chunks[chunkIndex].dirtyTiles.reset();
+	}
+	m_dirtyChunks.clear();
+}
+
+TileChunk& TileMap::markDirty(glm::ivec2 tile, TileLayer layer)
+{
+	const uint32_t chunkIndex = getChunkIndex(tile);
+	TileChunk& chunk = m_chunks[chunkIndex];
+
+	if (chunk.dirtyLayers == 0)
+		m_dirtyChunks.push_back(chunkIndex);
+
+	chunk.dirtyLayers |= 1 << static_cast<uint8_t>(layer);
+	chunk.dirtyTiles.set(getLocalIndex(tile));
+	chunk.version = ++m_version;
+	return chunk;
+}
+
+void TileMap::record(glm::ivec2 tile, const TileState& before)
+{
+	if (m_journal != nullptr)
+		m_journal->record(getChunkIndex(tile), static_cast<uint16_t>(getLocalIndex(tile)), before, getState(tile));
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+// 4 bits per tile, at most 16 kinds
+enum class Terrain : uint8_t
+{
+	Soil,
+	Grass,
+	Sand,
+	Gravel,
+	// natural rock, blocks movement until mined
+	Rock,
+	ShallowWater,
+	DeepWater,
+	Floor,
+	Count
+};
+
+// 4 bits per tile, combined into a mask
+enum class TileFlag : uint8_t
+{
+	Wall = 1 << 0,
+	Door = 1 << 1,
+	Roof = 1 << 2,
+	Stockpile = 1 << 3
+};
+
+// the per tile layers, also the bits of TileChunk::dirtyLayers
+enum class TileLayer : uint8_t
+{
+	Terrain,
+	Flags,
+	Room,
+	Count
+};
+
+// every layer of one tile, unpacked
+struct TileState
+{
+	Terrain terrain = Terrain::Soil;
+	uint8_t flags = 0;
+	uint16_t room = 0;
+
+	bool operator==(const TileState&) const = default;
+
+	// rock and deep water block movement, so do walls that aren't doors
+	bool isWalkable() const
+	{
+		if (terrain == Terrain::Rock || terrain == Terrain::DeepWater)
+			return false;
+		return (flags & static_cast<uint8_t>(TileFlag::Wall)) == 0 || (flags & static_cast<uint8_t>(TileFlag::Door)) != 0;
+	}
+};
+
+class TileJournal;
+
+// Bits wide fields packed into 64 bit words, fields never straddle two words
+template<uint32_t Bits, uint32_t Count>
+class PackedArray
+{
+public:
+	static_assert(Bits > 0 && Bits <= 16 && 64 % Bits == 0);
+
+	uint32_t get(uint32_t index) const
+	{
+		return static_cast<uint32_t>(m_words[index / fieldsPerWord] >> shift(index)) & fieldMask;
+	}
+
+	void set(uint32_t index, uint32_t value)
+	{
+		uint64_t& word = m_words[index / fieldsPerWord];
+		word = (word & ~(uint64_t(fieldMask) << shift(index))) | (uint64_t(value & fieldMask) << shift(index));
+	}
+
+	void fill(uint32_t value)
+	{
+		uint64_t word = 0;
+		for (uint32_t i = 0; i < fieldsPerWord; i++)
+			word |= uint64_t(value & fieldMask) << (i * Bits);
+		m_words.fill(word);
+	}
+
+private:
+	static constexpr uint32_t fieldsPerWord = 64 / Bits;
+	static constexpr uint32_t fieldMask = (1u << Bits) - 1;
+
+	static uint32_t shift(uint32_t index) { return (index % fieldsPerWord) * Bits; }
+
+	std::array<uint64_t, (Count + fieldsPerWord - 1) / fieldsPerWord> m_words = {};
+};
+
+// a 32x32 block of tiles, one array per layer. tiles are row major inside the chunk
+struct TileChunk
+{
+	static constexpr uint32_t sizeBits = 5;
+	static constexpr uint32_t size = 1 << sizeBits;
+	static constexpr uint32_t tileCount = size * size;
+
+	PackedArray<4, tileCount> terrain;
+	PackedArray<4, tileCount> flags;
+	// 0 is outdoors
+	std::array<uint16_t, tileCount> room = {};
+
+	// map version of the last change to this chunk
+	uint64_t version = 0;
+	// what changed since the map's last clearDirty, one bit per TileLayer and one per tile
+	uint8_t dirtyLayers = 0;
+	std::bitset<tileCount> dirtyTiles;
+};
+
+// the world grid, made of chunks so consumers (rendering, pathfinding, saving) can skip everything that didn't
+// change. every setter is O(1) and only marks the chunk dirty when the value actually changes. about 3.2 bytes
+// per tile including dirty tracking, so a 1024x1024 map takes a bit over 3 MB
+class TileMap
+{
+public:
+	// width and height are rounded up to whole chunks
+	void create(uint32_t width, uint32_t height, Terrain fill = Terrain::Soil);
+
+	uint32_t getWidth() const { return m_chunkCount.x * TileChunk::size; }
+	uint32_t getHeight() const { return m_chunkCount.y * TileChunk::size; }
+	glm::ivec2 getChunkCount() const { return m_chunkCount; }
+	bool isInBounds(glm::ivec2 tile) const
+	{
+		return tile.x >= 0 && tile.y >= 0 && static_cast<uint32_t>(tile.x) < getWidth() && static_cast<uint32_t>(tile.y) < getHeight();
+	}
+
+	// tiles must be in bounds
+	Terrain getTerrain(glm::ivec2 tile) const { return static_cast<Terrain>(getChunk(tile).terrain.get(getLocalIndex(tile))); }
+	uint8_t getFlags(glm::ivec2 tile) const { return static_cast<uint8_t>(getChunk(tile).flags.get(getLocalIndex(tile))); }
+	bool hasFlag(glm::ivec2 tile, TileFlag flag) const { return (getFlags(tile) & static_cast<uint8_t>(flag)) != 0; }
+	uint16_t getRoom(glm::ivec2 tile) const { return getChunk(tile).room[getLocalIndex(tile)]; }
+	TileState getState(glm::ivec2 tile) const;
+
+	void setTerrain(glm::ivec2 tile, Terrain terrain);
+	// bits above the four TileFlags are dropped
+	void setFlags(glm::ivec2 tile, uint8_t flags);
+	void setFlag(glm::ivec2 tile, TileFlag flag, bool value);
+	void setRoom(glm::ivec2 tile, uint16_t room);
+
+	// false out of bounds, otherwise TileState::isWalkable
+	bool isWalkable(glm::ivec2 tile) const;
+
+	// every change from now on is recorded in journal as well, nullptr stops recording. the journal must outlive
+	// the map or be detached first
+	void setJournal(TileJournal* journal) { m_journal = journal; }
+
+	uint32_t getChunkIndex(glm::ivec2 tile) const
+	{
+		return static_cast<uint32_t>(tile.y >> TileChunk::sizeBits) * m_chunkCount.x + static_cast<uint32_t>(tile.x >> TileChunk::sizeBits);
+	}
+	static uint32_t getLocalIndex(glm::ivec2 tile)
+	{
+		return ((static_cast<uint32_t>(tile.y) & (TileChunk::size - 1)) << TileChunk::sizeBits) | (static_cast<uint32_t>(tile.x) & (TileChunk::size - 1));
+	}
+	// tile at the chunk's top left corner
+	glm::ivec2 getChunkOrigin(uint32_t chunkIndex) const
+	{
+		return { static_cast<int>(chunkIndex % m_chunkCount.x * TileChunk::size), static_cast<int>(chunkIndex / m_chunkCount.x * TileChunk::size) };
+	}
+	// inverse of getChunkIndex and getLocalIndex
+	glm::ivec2 getTile(uint32_t chunkIndex, uint32_t local) const
+	{
+		const glm::ivec2 origin = getChunkOrigin(chunkIndex);
+		return { origin.x + static_cast<int>(local & (TileChunk::size - 1)), origin.y + static_cast<int>(local >> TileChunk::sizeBits) };
+	}
+
+	const TileChunk& getChunk(uint32_t chunkIndex) const { return m_chunks[chunkIndex]; }
+	const TileChunk& getChunk(glm::ivec2 tile) const { return m_chunks[getChunkIndex(tile)]; }
+
+	// bumped by every change, consumers that poll remember it and compare it against TileChunk::version
+	uint64_t getVersion() const { return m_version; }
+	// func(uint32_t chunkIndex, const TileChunk& chunk) for every chunk changed after version
+	template<class Func>
+	void forEachChunkChangedSince(uint64_t version, Func&& func) const;
+
+	// chunks with a dirty bit set, in the order they were first changed
+	const std::vector<uint32_t>& getDirtyChunks() const { return m_dirtyChunks; }
+	// called once every consumer has seen the dirty chunks, right after the journal is published
+	void clearDirty();
+
+	size_t getMemoryUsage() const { return m_chunks.capacity() * sizeof(TileChunk) + m_dirtyChunks.capacity() * sizeof(uint32_t); }
+
+private:
+	TileChunk& markDirty(glm::ivec2 tile, TileLayer layer);
+	// hands a change that was just made to the journal, if there is one
+	void record(glm::ivec2 tile, const TileState& before);
+
+	glm::ivec2 m_chunkCount = { 0, 0 };
+	std::vector<TileChunk> m_chunks;
+	uint64_t m_version = 0;
+	std::vector<uint32_t> m_dirtyChunks;
+	TileJournal* m_journal = nullptr;
+};
+
+template<class Func>
+void TileMap::forEachChunkChangedSince(uint64_t version, Func&& func) const
+{
+	for (uint32_t chunkIndex = 0; chunkIndex < m_chunks.size(); chunkIndex++)
+	{
+		if (m_chunks[chunkIndex].version > version)
+			func(chunkIndex, m_chunks[chunkIndex]);
+	}
+}
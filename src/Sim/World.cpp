@@ -0,0 +1,106 @@
+#include "World.h"
+
+#include <cstring>
+
+void World::destroy(Entity entity)
+{
+	if (!isAlive(entity))
+		return;
+
+	EntitySlot& slot = m_slots[entity.index];
+	removeRow(*slot.archetype, slot.row);
+
+	// the new generation invalidates every handle to this entity
+	slot.archetype = nullptr;
+	slot.generation++;
+	m_freeSlots.push_back(entity.index);
+	m_entityCount--;
+}
+
+bool World::isAlive(Entity entity) const
+{
+	return entity.index < m_slots.size() && m_slots[entity.index].generation == entity.generation &&
+		   m_slots[entity.index].archetype != nullptr;
+}
+
+Entity World::allocate(Archetype& archetype)
+{
+	Entity entity;
+	if (!m_freeSlots.empty())
+	{
+		entity.index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		entity.index = static_cast<uint32_t>(m_slots.size());
+		m_slots.emplace_back();
+	}
+
+	EntitySlot& slot = m_slots[entity.index];
+	entity.generation = slot.generation;
+	slot.archetype = &archetype;
+	slot.row = archetype.pushBack(entity);
+
+	m_entityCount++;
+	return entity;
+}
+
+Archetype& World::getArchetype(const ComponentMask& mask)
+{
+	auto it = m_archetypes.find(mask);
+	if (it != m_archetypes.end())
+		return *it->second;
+
+	auto archetype = std::make_unique<Archetype>(mask);
+	m_archetypeList.push_back(archetype.get());
+	return *m_archetypes.emplace(mask, std::move(archetype)).first->second;
+}
+
+Archetype& World::getAddTarget(Archetype& from, ComponentId id)
+{
+	if (from.addEdges[id] == nullptr)
+	{
+		Archetype& to = getArchetype(ComponentMask(from.getMask()).set(id));
+		from.addEdges[id] = &to;
+		to.removeEdges[id] = &from;
+	}
+	return *from.addEdges[id];
+}
+
+Archetype& World::getRemoveTarget(Archetype& from, ComponentId id)
+{
+	if (from.removeEdges[id] == nullptr)
+	{
+		Archetype& to = getArchetype(ComponentMask(from.getMask()).reset(id));
+		from.removeEdges[id] = &to;
+		to.addEdges[id] = &from;
+	}
+	return *from.removeEdges[id];
+}
+
+void World::move(Entity entity, Archetype& to)
+{
+	EntitySlot& slot = m_slots[entity.index];
+	Archetype& from = *slot.archetype;
+	const uint32_t fromRow = slot.row;
+	const uint32_t toRow = to.pushBack(entity);
+
+	const ComponentMask shared = from.getMask() & to.getMask();
+	for (ComponentId id = 0; id < maxComponents; id++)
+	{
+		if (shared.test(id))
+			memcpy(to.getComponent(toRow, id), from.getComponent(fromRow, id), getComponentInfo(id).size);
+	}
+
+	removeRow(from, fromRow);
+	slot.archetype = &to;
+	slot.row = toRow;
+}
+
+void World::removeRow(Archetype& archetype, uint32_t row)
+{
+	const Entity moved = archetype.swapRemove(row);
+	if (moved.isValid())
+		m_slots[moved.index].row = row;
+}
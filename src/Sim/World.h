@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Sim/Archetype.h"
+#include "Sim/Component.h"
+#include "Sim/Entity.h"
+#include "Utils/JobSystem.hpp"
+
+class World;
+
+// every archetype holding at least Ts, found once and then topped up as new archetypes appear. const
+// components are only read. the world must not be structurally changed (create, destroy, add, remove)
+// while a query is iterating
+template<class ... Ts>
+class Query
+{
+public:
+	explicit Query(World& world)
+		: m_world(&world), m_mask(makeComponentMask<std::remove_const_t<Ts>...>())
+	{
+	}
+
+	// func(Ts&... components) per entity
+	template<class Func>
+	void forEach(Func&& func);
+
+	// func(uint32_t count, const Entity* entities, Ts*... columns) per chunk, the columns are contiguous arrays
+	template<class Func>
+	void forEachChunk(Func&& func);
+
+	// forEachChunk with the chunks spread over the job system, func runs concurrently so it must only touch
+	// the rows it is given
+	template<class Func>
+	void forEachChunkParallel(Func&& func);
+
+	uint32_t getCount();
+
+private:
+	void refresh();
+
+	World* m_world;
+	ComponentMask m_mask;
+	std::vector<Archetype*> m_archetypes;
+	size_t m_checkedArchetypes = 0;
+
+	// flattened (archetype, chunk) list for forEachChunkParallel, kept to reuse its allocation
+	std::vector<std::pair<Archetype*, uint32_t>> m_chunks;
+};
+
+// entities are rows in the archetype matching their component set. structural changes move the row to another
+// archetype and fill the hole with the archetype's last row, so every operation is O(1) in the entity count
+class World
+{
+public:
+	World() = default;
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	template<class ... Ts>
+	Entity create(const Ts& ... components);
+	void destroy(Entity entity);
+	bool isAlive(Entity entity) const;
+
+	// overwrites the component if the entity already has it
+	template<class T>
+	void add(Entity entity, const T& component);
+	template<class T>
+	void remove(Entity entity);
+
+	// nullptr if the entity is dead or doesn't have T, valid until the next structural change
+	template<class T>
+	T* get(Entity entity);
+	template<class T>
+	bool has(Entity entity) const;
+
+	uint32_t getEntityCount() const { return m_entityCount; }
+	// every live entity's index is below this, for arrays indexed by Entity::index
+	uint32_t getSlotCount() const { return static_cast<uint32_t>(m_slots.size()); }
+	// in creation order, archetypes are never destroyed
+	const std::vector<Archetype*>& getArchetypes() const { return m_archetypeList; }
+
+	template<class ... Ts>
+	Query<Ts...> query()
+	{
+		return Query<Ts...>(*this);
+	}
+
+	template<class ... Ts, class Func>
+	void forEach(Func&& func)
+	{
+		query<Ts...>().forEach(std::forward<Func>(func));
+	}
+
+private:
+	struct EntitySlot
+	{
+		Archetype* archetype = nullptr;
+		uint32_t row = 0;
+		uint32_t generation = 0;
+	};
+
+	Entity allocate(Archetype& archetype);
+	Archetype& getArchetype(const ComponentMask& mask);
+	Archetype& getAddTarget(Archetype& from, ComponentId id);
+	Archetype& getRemoveTarget(Archetype& from, ComponentId id);
+	// moves the entity's row into to, keeping the components both archetypes have
+	void move(Entity entity, Archetype& to);
+	void removeRow(Archetype& archetype, uint32_t row);
+
+	std::vector<EntitySlot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	uint32_t m_entityCount = 0;
+
+	std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> m_archetypes;
+	std::vector<Archetype*> m_archetypeList;
+};
+
+template<class ... Ts>
+Entity World::create(const Ts& ... components)
+{
+	Archetype& archetype = getArchetype(makeComponentMask<Ts...>());
+	const Entity entity = allocate(archetype);
+	const uint32_t row = m_slots[entity.index].row;
+
+	(new (archetype.getComponent(row, getComponentId<Ts>())) Ts(components), ...);
+	return entity;
+}
+
+template<class T>
+void World::add(Entity entity, const T& component)
+{
+	if (!isAlive(entity))
+		return;
+
+	const ComponentId id = getComponentId<T>();
+	EntitySlot& slot = m_slots[entity.index];
+	if (!slot.archetype->has(id))
+		move(entity, getAddTarget(*slot.archetype, id));
+
+	new (slot.archetype->getComponent(slot.row, id)) T(component);
+}
+
+template<class T>
+void World::remove(Entity entity)
+{
+	const ComponentId id = getComponentId<T>();
+	if (!isAlive(entity) || !m_slots[entity.index].archetype->has(id))
+		return;
+
+	move(entity, getRemoveTarget(*m_slots[entity.index].archetype, id));
+}
+
+template<class T>
+T* World::get(Entity entity)
+{
+	const ComponentId id = getComponentId<T>();
+	if (!isAlive(entity) || !m_slots[entity.index].archetype->has(id))
+		return nullptr;
+
+	const EntitySlot& slot = m_slots[entity.index];
+	return static_cast<T*>(slot.archetype->getComponent(slot.row, id));
+}
+
+template<class T>
+bool World::has(Entity entity) const
+{
+	return isAlive(entity) && m_slots[entity.index].archetype->has(getComponentId<T>());
+}
+
+template<class ... Ts>
+template<class Func>
+void Query<Ts...>::forEach(Func&& func)
+{
+	forEachChunk([&func](uint32_t count, const Entity*, Ts* ... columns) {
+		for (uint32_t i = 0; i < count; i++)
+			func(columns[i]...);
+	});
+}
+
+template<class ... Ts>
+template<class Func>
+void Query<Ts...>::forEachChunk(Func&& func)
+{
+	refresh();
+
+	for (Archetype* archetype : m_archetypes)
+	{
+		const uint32_t chunkCount = archetype->getChunkCount();
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+			func(archetype->getChunkRows(chunk), archetype->getEntities(chunk), archetype->getColumn<std::remove_const_t<Ts>>(chunk)...);
+	}
+}
+
+template<class ... Ts>
+template<class Func>
+void Query<Ts...>::forEachChunkParallel(Func&& func)
+{
+	refresh();
+
+	m_chunks.clear();
+	for (Archetype* archetype : m_archetypes)
+	{
+		const uint32_t chunkCount = archetype->getChunkCount();
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+			m_chunks.emplace_back(archetype, chunk);
+	}
+
+	JobSystem::ParallelFor(static_cast<uint32_t>(m_chunks.size()), 1, [this, &func](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			auto [archetype, chunk] = m_chunks[i];
+			func(archetype->getChunkRows(chunk), archetype->getEntities(chunk), archetype->getColumn<std::remove_const_t<Ts>>(chunk)...);
+		}
+	});
+}
+
+template<class ... Ts>
+uint32_t Query<Ts...>::getCount()
+{
+	refresh();
+
+	uint32_t count = 0;
+	for (const Archetype* archetype : m_archetypes)
+		count += archetype->getCount();
+	return count;
+}
+
+template<class ... Ts>
+void Query<Ts...>::refresh()
+{
+	const std::vector<Archetype*>& archetypes = m_world->getArchetypes();
+	for (; m_checkedArchetypes < archetypes.size(); m_checkedArchetypes++)
+	{
+		Archetype* archetype = archetypes[m_checkedArchetypes];
+		if ((archetype->getMask() & m_mask) == m_mask)
+			m_archetypes.push_back(archetype);
+	}
+}
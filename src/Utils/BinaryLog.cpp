@@ -0,0 +1,197 @@
+#include "BinaryLog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+
+std::atomic<uint64_t> BinaryLog::m_Dropped = 0;
+
+// single producer (the owning thread) single consumer (the console thread) byte ring
+class BinaryLog::ThreadBuffer
+{
+public:
+    explicit ThreadBuffer(size_t capacity)
+        : m_Data(std::make_unique<std::byte[]>(capacity)), m_Capacity(capacity)
+    {
+    }
+
+    std::byte* Reserve(size_t size)
+    {
+        const uint64_t head = m_Head.load(std::memory_order_acquire);
+        uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+
+        const size_t offset = tail % m_Capacity;
+        const size_t toEnd = m_Capacity - offset;
+        // records never straddle the end, a record that doesn't fit skips the rest of the ring
+        const size_t skip = toEnd < size ? toEnd : 0;
+
+        if (m_Capacity - (tail - head) < size + skip)
+            return nullptr;
+
+        if (skip != 0)
+        {
+            const uint32_t marker = 0;
+            memcpy(m_Data.get() + offset, &marker, sizeof(marker));
+            tail += skip;
+        }
+
+        m_Reserved = tail;
+        return m_Data.get() + tail % m_Capacity;
+    }
+
+    void Commit(size_t size) { m_Tail.store(m_Reserved + size, std::memory_order_release); }
+
+    template<class Func>
+    void Consume(Func&& func)
+    {
+        uint64_t head = m_Head.load(std::memory_order_relaxed);
+        const uint64_t tail = m_Tail.load(std::memory_order_acquire);
+
+        while (head != tail)
+        {
+            const size_t offset = head % m_Capacity;
+
+            RecordHeader header;
+            memcpy(&header.size, m_Data.get() + offset, sizeof(header.size));
+            if (header.size == 0)
+            {
+                head += m_Capacity - offset;
+                continue;
+            }
+
+            memcpy(&header, m_Data.get() + offset, sizeof(header));
+            func(header, m_Data.get() + offset + sizeof(RecordHeader));
+            head += header.size;
+        }
+
+        m_Head.store(head, std::memory_order_release);
+    }
+
+    bool IsEmpty() const { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+
+    // set when the owning thread exits, the buffer is released once it has been drained
+    std::atomic<bool> Abandoned = false;
+
+private:
+    std::unique_ptr<std::byte[]> m_Data;
+    size_t m_Capacity;
+    uint64_t m_Reserved = 0;
+
+    alignas(64) std::atomic<uint64_t> m_Tail = 0;
+    alignas(64) std::atomic<uint64_t> m_Head = 0;
+};
+
+namespace
+{
+struct Registry
+{
+    std::mutex Mutex;
+    std::vector<std::shared_ptr<BinaryLog::ThreadBuffer>> Buffers;
+
+    // wall clock time at a known monotonic time, records are converted to local time relative to it
+    std::chrono::system_clock::time_point SystemStart = std::chrono::system_clock::now();
+    std::chrono::steady_clock::time_point SteadyStart = std::chrono::steady_clock::now();
+};
+
+Registry& GetRegistry()
+{
+    // leaked on purpose, the console is a static too and drains one last time while statics are being destroyed
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+struct ThreadBufferHandle
+{
+    ThreadBufferHandle()
+        : Buffer(std::make_shared<BinaryLog::ThreadBuffer>(BinaryLog::ThreadBufferSize))
+    {
+        // registration is the only locked step and only happens on a thread's first binary log
+        Registry& registry = GetRegistry();
+        std::scoped_lock lock(registry.Mutex);
+        registry.Buffers.push_back(Buffer);
+    }
+
+    ~ThreadBufferHandle() { Buffer->Abandoned.store(true, std::memory_order_release); }
+
+    std::shared_ptr<BinaryLog::ThreadBuffer> Buffer;
+};
+
+thread_local ThreadBufferHandle t_Buffer;
+} // namespace
+
+uint64_t BinaryLog::Now()
+{
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+std::byte* BinaryLog::Reserve(size_t size)
+{
+    if (size > ThreadBufferSize)
+        return nullptr;
+    return t_Buffer.Buffer->Reserve(size);
+}
+
+void BinaryLog::Commit(size_t size)
+{
+    t_Buffer.Buffer->Commit(size);
+}
+
+void BinaryLog::Drain(std::vector<ConsoleMessage>& messages)
+{
+    const size_t first = messages.size();
+
+    Registry& registry = GetRegistry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::scoped_lock lock(registry.Mutex);
+        std::erase_if(registry.Buffers, [](const auto& buffer) { return buffer->Abandoned.load(std::memory_order_acquire) && buffer->IsEmpty(); });
+        buffers = registry.Buffers;
+    }
+
+    for (const auto& buffer : buffers)
+    {
+        buffer->Consume([&messages](const RecordHeader& header, const std::byte* args) {
+            const std::string text = header.decode(std::string_view(header.format, header.formatLength), args);
+
+            ConsoleMessage& message = messages.emplace_back();
+            message.type = header.type;
+            message.category = header.category;
+            message.timestamp = header.timestamp;
+            message.length = static_cast<uint16_t>(std::min(text.size(), ConsoleMessage::MaxLength));
+            message.truncated = message.length < text.size();
+            memcpy(message.message, text.data(), message.length);
+            FormatTime(header.timestamp, message.time);
+        });
+    }
+
+    // each thread's records are already in order, this interleaves the threads
+    std::stable_sort(messages.begin() + static_cast<std::ptrdiff_t>(first), messages.end(),
+                     [](const ConsoleMessage& a, const ConsoleMessage& b) { return a.timestamp < b.timestamp; });
+}
+
+bool BinaryLog::IsEmpty()
+{
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock(registry.Mutex);
+    return std::all_of(registry.Buffers.begin(), registry.Buffers.end(), [](const auto& buffer) { return buffer->IsEmpty(); });
+}
+
+void BinaryLog::FormatTime(uint64_t timestamp, char (&buffer)[ConsoleMessage::TimeLength])
+{
+    const Registry& registry = GetRegistry();
+    const auto sinceStart = std::chrono::steady_clock::duration(static_cast<std::chrono::steady_clock::rep>(timestamp)) -
+                            registry.SteadyStart.time_since_epoch();
+    const time_t time =
+        std::chrono::system_clock::to_time_t(registry.SystemStart + std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceStart));
+
+    std::tm localTime;
+#ifdef WIN32
+    localtime_s(&localTime, &time);
+#else
+    localtime_r(&time, &localTime);
+#endif
+
+    if (std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &localTime) == 0)
+        buffer[0] = '\0';
+}
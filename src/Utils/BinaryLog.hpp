@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "Console.hpp"
+
+// argument encoding for deferred log records. arithmetic and enum values are stored as raw bytes, strings are
+// copied in (length prefixed) and come back out as string_views into the record
+template<class T>
+struct BinaryLogArg
+{
+    using Decoded = T;
+
+    static size_t Size(const T&) { return sizeof(T); }
+
+    static std::byte* Encode(std::byte* dst, const T& value)
+    {
+        memcpy(dst, &value, sizeof(T));
+        return dst + sizeof(T);
+    }
+
+    static Decoded Decode(const std::byte*& src)
+    {
+        T value;
+        memcpy(&value, src, sizeof(T));
+        src += sizeof(T);
+        return value;
+    }
+};
+
+struct BinaryLogStringArg
+{
+    using Decoded = std::string_view;
+
+    static size_t Size(std::string_view value) { return sizeof(uint32_t) + value.size(); }
+
+    static std::byte* Encode(std::byte* dst, std::string_view value)
+    {
+        const uint32_t length = static_cast<uint32_t>(value.size());
+        memcpy(dst, &length, sizeof(length));
+        memcpy(dst + sizeof(length), value.data(), length);
+        return dst + sizeof(length) + length;
+    }
+
+    static Decoded Decode(const std::byte*& src)
+    {
+        uint32_t length = 0;
+        memcpy(&length, src, sizeof(length));
+        const char* data = reinterpret_cast<const char*>(src + sizeof(length));
+        src += sizeof(length) + length;
+        return std::string_view(data, length);
+    }
+};
+
+template<> struct BinaryLogArg<std::string> : BinaryLogStringArg {};
+template<> struct BinaryLogArg<std::string_view> : BinaryLogStringArg {};
+template<> struct BinaryLogArg<const char*> : BinaryLogStringArg {};
+template<> struct BinaryLogArg<char*> : BinaryLogStringArg {};
+
+// records log calls as a format string pointer, a monotonic timestamp and the raw argument bytes into a buffer
+// owned by the calling thread. all formatting (including the timestamp) happens when the console thread drains
+class BinaryLog
+{
+public:
+    // renders a record's arguments with its format string, one instantiation per argument type list
+    using Decoder = std::string (*)(std::string_view format, const std::byte* args);
+
+    // only types whose bytes are the whole value. a trivially copyable type can still point at something (a
+    // pointer, a span, a struct holding one) that is gone by the time the console formats it, so anything else
+    // is formatted on the calling thread
+    template<class T>
+    static constexpr bool IsEncodable = std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_base_of_v<BinaryLogStringArg, BinaryLogArg<T>>;
+
+    // bytes of record storage per thread, records that don't fit are dropped and counted
+    static constexpr size_t ThreadBufferSize = 256 * 1024;
+
+    // format has to point at storage that outlives the log (a string literal)
+    template<class ... Args>
+    static bool Write(ConsoleMessage::Type type, LogCategory category, std::string_view format, const Args& ... args);
+
+    // console thread only, decodes every pending record across all threads and appends them to messages ordered
+    // by timestamp
+    static void Drain(std::vector<ConsoleMessage>& messages);
+    static bool IsEmpty();
+
+    static uint64_t TakeDropped() { return m_Dropped.exchange(0, std::memory_order_relaxed); }
+
+    static uint64_t Now();
+
+    // per thread record storage, public only so the thread local owning it can name it
+    class ThreadBuffer;
+
+private:
+    struct RecordHeader
+    {
+        // 0 marks the unused tail of the ring before it wraps
+        uint32_t size;
+        uint32_t formatLength;
+        const char* format;
+        Decoder decode;
+        uint64_t timestamp;
+        ConsoleMessage::Type type;
+        LogCategory category;
+    };
+
+    template<class ... Args>
+    static std::string Decode(std::string_view format, const std::byte* args);
+
+    static std::byte* Reserve(size_t size);
+    static void Commit(size_t size);
+
+    static void FormatTime(uint64_t timestamp, char (&buffer)[ConsoleMessage::TimeLength]);
+
+    static std::atomic<uint64_t> m_Dropped;
+};
+
+template<class ... Args>
+bool BinaryLog::Write(ConsoleMessage::Type type, LogCategory category, std::string_view format, const Args& ... args)
+{
+    const size_t argsSize = (size_t(0) + ... + BinaryLogArg<Args>::Size(args));
+    // records stay 8 byte aligned so the headers can be read in place
+    const size_t size = (sizeof(RecordHeader) + argsSize + 7) & ~size_t(7);
+
+    std::byte* record = Reserve(size);
+    if (record == nullptr)
+    {
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    RecordHeader header;
+    header.size = static_cast<uint32_t>(size);
+    header.formatLength = static_cast<uint32_t>(format.size());
+    header.format = format.data();
+    header.decode = &Decode<Args...>;
+    header.timestamp = Now();
+    header.type = type;
+    header.category = category;
+    memcpy(record, &header, sizeof(header));
+
+    std::byte* cursor = record + sizeof(RecordHeader);
+    ((cursor = BinaryLogArg<Args>::Encode(cursor, args)), ...);
+
+    Commit(size);
+    return true;
+}
+
+template<class ... Args>
+std::string BinaryLog::Decode(std::string_view format, const std::byte* args)
+{
+    const std::byte* cursor = args;
+    // braced initialization evaluates left to right, which is the order the arguments were encoded in
+    std::tuple<typename BinaryLogArg<Args>::Decoded...> values { BinaryLogArg<Args>::Decode(cursor)... };
+
+    return std::apply([format](auto& ... values) { return std::vformat(format, std::make_format_args(values...)); }, values);
+}
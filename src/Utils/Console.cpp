@@ -1,5 +1,9 @@
 #include "Console.hpp"
+#include "BinaryLog.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <print>
 #include <iostream>
@@ -16,25 +20,31 @@
 std::shared_ptr<Console> Console::m_Instance = std::make_shared<Console>();
 
 Console::Console()
+	: m_MessageQueue(QueueCapacity)
 {
 	if (m_Instance)
 	{
 		std::println("Console::Console() - Instance already exists");
 		return;
 	}
-	m_Thread = std::thread(&Console::ThreadLoop, this);
+	m_Batch.resize(BatchSize);
 	m_Running = true;
+	m_Thread = std::thread(&Console::ThreadLoop, this);
 }
 
 Console::~Console()
 {
 	m_Running = false;
-	m_QueueCondition.notify_all();
-	m_Thread.join();
+	m_WakeCounter.fetch_add(1);
+	m_WakeCounter.notify_one();
+	if (m_Thread.joinable())
+		m_Thread.join();
 }
 
 void Console::ThreadLoop()
 {
+	TRACE_THREAD_NAME("console");
+
 #ifdef WIN32
 	auto allocated = AllocConsole();
 
@@ -80,21 +90,38 @@ void Console::ThreadLoop()
 	std::cerr.rdbuf(logFile.rdbuf());*/
 #endif
 
-	while (m_Running)
+	// after the console is allocated so the sink sees the right stdout
+	AddSink(std::make_shared<TerminalSink>());
+
+	// drains in batches, whatever is still queued when the console shuts down is printed before the thread exits
+	for (;;)
 	{
-		ConsoleMessage message;
+		const size_t count = DrainBatch();
+
+		// deferred records are only formatted here, off the threads that logged them
+		m_Merged.clear();
+		BinaryLog::Drain(m_Merged);
+		const bool drained = count > 0 || !m_Merged.empty();
+
+		if (m_Merged.empty())
+			WriteToSinks(std::span(m_Batch.data(), count));
+		else
 		{
-			std::unique_lock<std::mutex> lock(m_QueueMutex);
-			m_QueueCondition.wait(lock, [this] { return !m_MessageQueue.empty() || !m_Running; });
+			// a message formatted eagerly right after a deferred one still has to come out after it
+			m_Merged.insert(m_Merged.end(), m_Batch.begin(), m_Batch.begin() + count);
+			std::ranges::stable_sort(m_Merged, {}, &ConsoleMessage::timestamp);
+			WriteToSinks(m_Merged);
+		}
+
+		ReportDropped();
 
+		if (!drained)
+		{
+			FlushSinks();
 			if (!m_Running)
 				break;
-
-			message = m_MessageQueue.front();
-			m_MessageQueue.pop();
+			WaitForMessages();
 		}
-
-		PrintMessage(message);
 	}
 
 #ifdef WIN32
@@ -108,107 +135,118 @@ void Console::ThreadLoop()
 #endif
 }
 
-void Console::QueueMessage(const std::string& message, ConsoleMessage::Type type, const std::string& time)
+void Console::QueueMessage(std::string_view message, ConsoleMessage::Type type, LogCategory category, std::string_view time, bool truncated)
 {
-	std::lock_guard<std::mutex> lock(m_QueueMutex);
-	m_MessageQueue.push({ type, message, time });
-	m_QueueCondition.notify_one();
+	const uint64_t timestamp = BinaryLog::Now();
+	const auto write = [&](ConsoleMessage& slot)
+	{
+		const size_t length = std::min(message.size(), ConsoleMessage::MaxLength);
+		const size_t timeLength = std::min(time.size(), ConsoleMessage::TimeLength - 1);
+
+		slot.type = type;
+		slot.category = category;
+		slot.timestamp = timestamp;
+		slot.truncated = truncated || length < message.size();
+		slot.length = static_cast<uint16_t>(length);
+		memcpy(slot.message, message.data(), length);
+		memcpy(slot.time, time.data(), timeLength);
+		slot.time[timeLength] = '\0';
+	};
+
+	while (!m_MessageQueue.TryPush(write))
+	{
+		switch (m_OverflowPolicy.load(std::memory_order_relaxed))
+		{
+		case OverflowPolicy::Drop:
+			return;
+		case OverflowPolicy::CountDrops:
+			m_Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		case OverflowPolicy::Block:
+			Wake();
+			std::this_thread::yield();
+			break;
+		}
+	}
+
+	Wake();
 }
 
-void Console::SetColor(ConsoleMessage::Type type) const
+size_t Console::DrainBatch()
 {
-	switch (type)
-	{
-	case ConsoleMessage::Type::Debug:
-		SetColor(ConsoleColor::Debug);
-		break;
-	case ConsoleMessage::Type::Info:
-		SetColor(ConsoleColor::Info);
-		break;
-	case ConsoleMessage::Type::Warning:
-		SetColor(ConsoleColor::Warning);
-		break;
-	case ConsoleMessage::Type::Error:
-		SetColor(ConsoleColor::Error);
-		break;
-	}
+	size_t count = 0;
+	while (count < m_Batch.size() && m_MessageQueue.TryPop([&](const ConsoleMessage& message) { m_Batch[count] = message; }))
+		count++;
+	return count;
 }
 
+void Console::WaitForMessages()
+{
+	const uint32_t wakeCounter = m_WakeCounter.load();
+	m_Sleeping.store(true);
+	// pairs with the fence in Wake, either the producer sees m_Sleeping or we see its message
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_MessageQueue.IsEmpty() && BinaryLog::IsEmpty() && m_Running)
+		m_WakeCounter.wait(wakeCounter);
 
-void Console::SetColor(ConsoleColor color) const
+	m_Sleeping.store(false, std::memory_order_relaxed);
+}
+
+void Console::Wake()
 {
-#ifdef WIN32
-	HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-	switch (color)
-	{
-	case ConsoleColor::Default:
-		SetConsoleTextAttribute(hConsole, 7);
-		break;
-	case ConsoleColor::Debug:
-		SetConsoleTextAttribute(hConsole, 10);
-		break;
-	case ConsoleColor::Info:
-		SetConsoleTextAttribute(hConsole, 11);
-		break;
-	case ConsoleColor::Warning:
-		SetConsoleTextAttribute(hConsole, 6);
-		break;
-	case ConsoleColor::Error:
-		SetConsoleTextAttribute(hConsole, 4);
-		break;
-	}
-#else
-	switch (color)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_Sleeping.load(std::memory_order_relaxed) && m_Sleeping.exchange(false))
 	{
-	case ConsoleColor::Default:
-		std::print("\033[0m");
-		break;
-	case ConsoleColor::Debug:
-		std::print("\033[32m");
-		break;
-	case ConsoleColor::Info:
-		std::print("\033[36m");
-		break;
-	case ConsoleColor::Warning:
-		std::print("\033[33m");
-		break;
-	case ConsoleColor::Error:
-		std::print("\033[31m");
-		break;
+		m_WakeCounter.fetch_add(1);
+		m_WakeCounter.notify_one();
 	}
-#endif
 }
 
-void Console::PrintMessage(const ConsoleMessage& message) const
+void Console::ReportDropped()
 {
-	SetColor(ConsoleColor::Default);
-	std::print("(");
-	std::print("{}", message.time);
-	std::print(") ");
-	std::print("[");
+	const uint64_t dropped = m_Dropped.exchange(0, std::memory_order_relaxed) + BinaryLog::TakeDropped();
+	if (dropped == 0)
+		return;
 
+	m_TotalDropped.fetch_add(dropped, std::memory_order_relaxed);
 
-	SetColor(message.type);
-	switch (message.type)
-	{
-	case ConsoleMessage::Type::Debug:
-		std::print("Debug");
-		break;
-	case ConsoleMessage::Type::Info:
-		std::print("Info");
-		break;
-	case ConsoleMessage::Type::Warning:
-		std::print("Warning");
-		break;
-	case ConsoleMessage::Type::Error:
-		std::print("Error");
-		break;
-	}
+	ConsoleMessage message = {};
+	message.type = ConsoleMessage::Type::Warning;
+	message.timestamp = BinaryLog::Now();
+	const auto result = std::format_to_n(message.message, ConsoleMessage::MaxLength, "console queue full, dropped {} messages", dropped);
+	message.length = static_cast<uint16_t>(std::min<size_t>(result.size, ConsoleMessage::MaxLength));
+	WriteToSinks(std::span(&message, 1));
+}
 
-	SetColor(ConsoleColor::Default);
-	std::print("] ");
-	std::print("{}", message.message);
-	std::print("\n");
+void Console::AddSink(std::shared_ptr<LogSink> sink)
+{
+	std::scoped_lock lock(m_SinkMutex);
+	m_Sinks.push_back(std::move(sink));
+}
+
+void Console::RemoveSink(const std::shared_ptr<LogSink>& sink)
+{
+	std::scoped_lock lock(m_SinkMutex);
+	std::erase(m_Sinks, sink);
+}
+
+void Console::WriteToSinks(std::span<const ConsoleMessage> messages)
+{
+	if (messages.empty())
+		return;
+
+	TRACE_ZONE("Console::WriteToSinks");
+	std::scoped_lock lock(m_SinkMutex);
+	for (const auto& sink : m_Sinks)
+		sink->Write(messages);
+}
+
+void Console::FlushSinks()
+{
+	std::scoped_lock lock(m_SinkMutex);
+	for (const auto& sink : m_Sinks)
+		sink->Flush();
 }
 
 std::weak_ptr<Console> Console::Get()
@@ -1,14 +1,25 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <format>
-#include <mutex>
-#include <queue>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <thread>
-#include <condition_variable>
+#include <vector>
+
+#include "LogCategory.hpp"
+#include "LogSink.hpp"
+#include "MessageQueue.hpp"
 
+// fixed size so queue slots can be preallocated, longer messages are truncated
 struct ConsoleMessage
 {
+	static constexpr size_t MaxLength = 232;
+	static constexpr size_t TimeLength = 9;
+
 	enum class Type : uint8_t
 	{
 		Debug,
@@ -18,17 +29,26 @@ struct ConsoleMessage
 	};
 
 	Type type;
-	std::string message;
-	std::string time;
+	LogCategory category;
+	// steady clock ticks when the message was logged (see BinaryLog::Now), orders eager and deferred messages
+	uint64_t timestamp;
+	bool truncated;
+	uint16_t length;
+	char time[TimeLength];
+	char message[MaxLength];
+
+	std::string_view GetText() const { return std::string_view(message, length); }
+	std::string_view GetTime() const { return time; }
 };
 
-enum class ConsoleColor : uint8_t
+// what QueueMessage does when the queue is full
+enum class OverflowPolicy : uint8_t
 {
-	Default,
-	Debug,
-	Info,
-	Warning,
-	Error
+	Drop,
+	// spins until the console thread frees a slot, only for when losing messages is worse than stalling
+	Block,
+	// drops the message and reports how many were lost once the console thread catches up
+	CountDrops
 };
 
 class Console
@@ -42,23 +62,52 @@ public:
 	Console();
 	~Console();
 
-	void QueueMessage(const std::string& message, ConsoleMessage::Type type, const std::string& time);
+	// never allocates, and never blocks unless the overflow policy is Block
+	void QueueMessage(std::string_view message, ConsoleMessage::Type type, LogCategory category, std::string_view time, bool truncated = false);
+
+	// wakes the console thread if it is sleeping, for producers that bypass QueueMessage (binary logging)
+	void Wake();
 
-	void SetColor(ConsoleMessage::Type type) const;
-	void SetColor(ConsoleColor color) const;
-	void PrintMessage(const ConsoleMessage& message) const;
+	void SetOverflowPolicy(OverflowPolicy policy) { m_OverflowPolicy.store(policy, std::memory_order_relaxed); }
+	uint64_t GetDroppedCount() const { return m_TotalDropped.load(std::memory_order_relaxed); }
+
+	// every drained batch goes to each sink, the console starts out with a TerminalSink
+	void AddSink(std::shared_ptr<LogSink> sink);
+	void RemoveSink(const std::shared_ptr<LogSink>& sink);
 
 	static std::weak_ptr<Console> Get();
 
+	static constexpr size_t QueueCapacity = 4096;
+	static constexpr size_t BatchSize = 256;
+
 private:
 	void ThreadLoop();
+	// pops up to BatchSize messages into m_Batch
+	size_t DrainBatch();
+	void WaitForMessages();
+	void ReportDropped();
+	void WriteToSinks(std::span<const ConsoleMessage> messages);
+	void FlushSinks();
 
 	FILE* m_Console;
 
-	std::mutex m_QueueMutex;
-	std::queue<ConsoleMessage> m_MessageQueue;
-	std::condition_variable m_QueueCondition;
-	bool m_Running;
+	MessageQueue<ConsoleMessage> m_MessageQueue;
+	std::vector<ConsoleMessage> m_Batch;
+	// deferred records decoded this round, with the eager batch merged in when there are any
+	std::vector<ConsoleMessage> m_Merged;
+
+	// only contended when a sink is added or removed
+	std::mutex m_SinkMutex;
+	std::vector<std::shared_ptr<LogSink>> m_Sinks;
+
+	std::atomic<OverflowPolicy> m_OverflowPolicy = OverflowPolicy::CountDrops;
+	std::atomic<uint64_t> m_Dropped = 0;
+	std::atomic<uint64_t> m_TotalDropped = 0;
+
+	// producers only touch the wake counter when the console thread said it is about to sleep
+	std::atomic<bool> m_Sleeping = false;
+	std::atomic<uint32_t> m_WakeCounter = 0;
+	std::atomic<bool> m_Running = false;
 	std::thread m_Thread;
 
 	static std::shared_ptr<Console> m_Instance;
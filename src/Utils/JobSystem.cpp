@@ -0,0 +1,308 @@
+#include "JobSystem.hpp"
+#include "WorkStealingDeque.hpp"
+#include "Trace.hpp"
+
+#include <thread>
+#include <utility>
+
+struct Job
+{
+	std::function<void()> Func;
+	JobCounter* Counter = nullptr;
+	// next job waiting on the same dependency
+	Job* Next = nullptr;
+};
+
+class JobSystem::Worker
+{
+public:
+	WorkStealingDeque<Job> Deque { DequeCapacity };
+	std::thread Thread;
+};
+
+std::vector<std::unique_ptr<JobSystem::Worker>> JobSystem::m_Workers;
+std::atomic<bool> JobSystem::m_Running = false;
+
+std::mutex JobSystem::m_SharedMutex;
+std::deque<Job*> JobSystem::m_SharedJobs;
+std::atomic<uint32_t> JobSystem::m_SharedCount = 0;
+std::deque<Job*> JobSystem::m_BackgroundJobs;
+std::atomic<uint32_t> JobSystem::m_BackgroundCount = 0;
+
+std::atomic<uint32_t> JobSystem::m_Sleeping = 0;
+std::atomic<uint32_t> JobSystem::m_WakeCounter = 0;
+
+namespace
+{
+thread_local uint32_t t_WorkerIndex = JobSystem::InvalidWorker;
+
+// failed finds before a worker goes to sleep, keeps short gaps between batches of jobs off the futex
+constexpr uint32_t SpinsBeforeSleep = 64;
+} // namespace
+
+void JobSystem::Init(uint32_t workerCount)
+{
+	if (IsInitialized())
+		return;
+
+	if (workerCount == 0)
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (uint32_t i = 0; i < workerCount; i++)
+		m_Workers.push_back(std::make_unique<Worker>());
+
+	t_WorkerIndex = 0;
+	m_Running = true;
+	for (uint32_t i = 1; i < workerCount; i++)
+		m_Workers[i]->Thread = std::thread(&JobSystem::WorkerLoop, i);
+}
+
+void JobSystem::Shutdown()
+{
+	if (!IsInitialized())
+		return;
+
+	m_Running = false;
+	m_WakeCounter.fetch_add(1);
+	m_WakeCounter.notify_all();
+
+	for (auto& worker : m_Workers)
+	{
+		if (worker->Thread.joinable())
+			worker->Thread.join();
+	}
+
+	// whatever is left still runs, someone may be waiting on it
+	for (;;)
+	{
+		Job* job = FindJob(0);
+		if (job == nullptr)
+			job = PopQueue(m_BackgroundJobs, m_BackgroundCount);
+		if (job == nullptr)
+			break;
+		Execute(job);
+	}
+
+	m_Workers.clear();
+	t_WorkerIndex = InvalidWorker;
+}
+
+uint32_t JobSystem::GetWorkerIndex()
+{
+	return t_WorkerIndex;
+}
+
+void JobSystem::Run(std::function<void()> func, JobCounter* counter, JobCounter* dependency)
+{
+	Job* job = new Job { std::move(func), counter };
+
+	if (counter != nullptr)
+		counter->m_State.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency != nullptr)
+	{
+		std::scoped_lock lock(dependency->m_WaitingMutex);
+		// still counting, the job that brings it to zero takes the list under this lock and submits the job. once
+		// it is releasing the list may already be taken, so the job goes straight out
+		const uint32_t state = dependency->m_State.load(std::memory_order_acquire);
+		if (state != 0 && (state & JobCounter::Releasing) == 0)
+		{
+			job->Next = dependency->m_Waiting;
+			dependency->m_Waiting = job;
+			return;
+		}
+	}
+
+	Submit(job);
+}
+
+void JobSystem::RunBackground(std::function<void()> func, JobCounter* counter)
+{
+	if (GetWorkerCount() < 2)
+	{
+		Run(std::move(func), counter);
+		return;
+	}
+
+	Job* job = new Job { std::move(func), counter };
+	if (counter != nullptr)
+		counter->m_State.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		std::scoped_lock lock(m_SharedMutex);
+		m_BackgroundJobs.push_back(job);
+		m_BackgroundCount.fetch_add(1, std::memory_order_release);
+	}
+	WakeWorkers();
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	const uint32_t workerIndex = GetWorkerIndex();
+
+	while (!counter.IsDone())
+	{
+		Job* job = workerIndex != InvalidWorker ? FindJob(workerIndex) : nullptr;
+		if (job != nullptr)
+			Execute(job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::Submit(Job* job)
+{
+	const uint32_t workerIndex = GetWorkerIndex();
+	if (workerIndex != InvalidWorker && IsInitialized())
+	{
+		// a full deque means plenty of queued work already, running the job now keeps memory bounded
+		if (!m_Workers[workerIndex]->Deque.Push(job))
+		{
+			Execute(job);
+			return;
+		}
+	}
+	else if (IsInitialized())
+	{
+		std::scoped_lock lock(m_SharedMutex);
+		m_SharedJobs.push_back(job);
+		m_SharedCount.fetch_add(1, std::memory_order_release);
+	}
+	else
+	{
+		Execute(job);
+		return;
+	}
+
+	WakeWorkers();
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->Func();
+
+	JobCounter* counter = job->Counter;
+	delete job;
+
+	if (counter == nullptr)
+		return;
+
+	// the last job swaps the count for Releasing in one step, the counter must not read as done before the
+	// jobs waiting on it are taken
+	uint32_t state = counter->m_State.load(std::memory_order_relaxed);
+	while (!counter->m_State.compare_exchange_weak(state, state == 1 ? JobCounter::Releasing : state - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+	{
+	}
+
+	if (state != 1)
+		return;
+
+	Job* waiting = nullptr;
+	{
+		std::scoped_lock lock(counter->m_WaitingMutex);
+		waiting = std::exchange(counter->m_Waiting, nullptr);
+	}
+	// a job added while releasing keeps its count
+	counter->m_State.fetch_sub(JobCounter::Releasing, std::memory_order_release);
+
+	while (waiting != nullptr)
+	{
+		Job* next = waiting->Next;
+		Submit(waiting);
+		waiting = next;
+	}
+}
+
+Job* JobSystem::FindJob(uint32_t workerIndex)
+{
+	if (Job* job = m_Workers[workerIndex]->Deque.Pop())
+		return job;
+
+	if (Job* job = PopQueue(m_SharedJobs, m_SharedCount))
+		return job;
+
+	// start at the next worker so thieves spread out instead of all hitting worker 0
+	const uint32_t workerCount = GetWorkerCount();
+	for (uint32_t i = 1; i < workerCount; i++)
+	{
+		if (Job* job = m_Workers[(workerIndex + i) % workerCount]->Deque.Steal())
+			return job;
+	}
+
+	// worker 0 is the main thread, which only waits on work it needs for the frame
+	if (workerIndex != 0)
+		return PopQueue(m_BackgroundJobs, m_BackgroundCount);
+	return nullptr;
+}
+
+Job* JobSystem::PopQueue(std::deque<Job*>& jobs, std::atomic<uint32_t>& count)
+{
+	if (count.load(std::memory_order_acquire) == 0)
+		return nullptr;
+
+	std::scoped_lock lock(m_SharedMutex);
+	if (jobs.empty())
+		return nullptr;
+
+	Job* job = jobs.front();
+	jobs.pop_front();
+	count.fetch_sub(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::WorkerLoop(uint32_t workerIndex)
+{
+	t_WorkerIndex = workerIndex;
+	TRACE_THREAD_NAME("job worker");
+
+	uint32_t spins = 0;
+	while (m_Running.load(std::memory_order_relaxed))
+	{
+		if (Job* job = FindJob(workerIndex))
+		{
+			Execute(job);
+			spins = 0;
+			continue;
+		}
+
+		if (++spins < SpinsBeforeSleep)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		const uint32_t wakeCounter = m_WakeCounter.load();
+		m_Sleeping.fetch_add(1);
+		// pairs with the fence in WakeWorkers, either the submitter sees us sleeping or we see its job
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (!HasWork() && m_Running)
+			m_WakeCounter.wait(wakeCounter);
+
+		m_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+		spins = 0;
+	}
+}
+
+bool JobSystem::HasWork()
+{
+	if (m_SharedCount.load(std::memory_order_acquire) > 0 || m_BackgroundCount.load(std::memory_order_acquire) > 0)
+		return true;
+
+	for (const auto& worker : m_Workers)
+	{
+		if (!worker->Deque.IsEmpty())
+			return true;
+	}
+	return false;
+}
+
+void JobSystem::WakeWorkers()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_Sleeping.load(std::memory_order_relaxed) > 0)
+	{
+		m_WakeCounter.fetch_add(1);
+		m_WakeCounter.notify_one();
+	}
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct Job;
+
+// counts unfinished jobs, jobs can be made to wait for one to reach zero before they start. a counter can be
+// reused once it is done, but not while jobs are still being added to it from other threads
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const { return m_State.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	// set instead of the count by the job that brings it to zero, until the jobs waiting on the counter are
+	// handed out. clearing it is the last time a job touches the counter, so it can go out of scope once done
+	static constexpr uint32_t Releasing = 1u << 31;
+
+	// unfinished jobs, plus Releasing while the last one hands out the waiting jobs
+	std::atomic<uint32_t> m_State = 0;
+	// jobs depending on this counter, linked through Job::Next
+	std::mutex m_WaitingMutex;
+	Job* m_Waiting = nullptr;
+};
+
+// work stealing scheduler. the thread calling Init becomes worker 0, every other worker gets a thread of its own.
+// each worker pushes and pops jobs at one end of its own deque and steals from the other end of the others when it
+// runs dry, jobs submitted from threads that aren't workers go through a shared queue
+class JobSystem
+{
+public:
+	static constexpr uint32_t InvalidWorker = UINT32_MAX;
+	static constexpr size_t DequeCapacity = 4096;
+
+	// workerCount includes the calling thread, 0 uses every hardware thread
+	static void Init(uint32_t workerCount = 0);
+	static void Shutdown();
+
+	static bool IsInitialized() { return !m_Workers.empty(); }
+	static uint32_t GetWorkerCount() { return static_cast<uint32_t>(m_Workers.size()); }
+	// 0 to GetWorkerCount() - 1 on worker threads, InvalidWorker anywhere else. jobs only ever run on workers,
+	// so per worker data indexed by this is never shared between two running jobs
+	static uint32_t GetWorkerIndex();
+
+	// counter (if any) is incremented now and decremented once func has run. func doesn't start before
+	// dependency (if any) is done. jobs must not throw
+	static void Run(std::function<void()> func, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	// like Run, but the job only runs on the workers with a thread of their own, never on the thread that called Init,
+	// and only once they have nothing else to do. for long jobs that must not end up inside a Wait on the main
+	// thread. runs like Run when there is only one worker
+	static void RunBackground(std::function<void()> func, JobCounter* counter = nullptr);
+
+	// workers run other jobs while they wait, other threads yield until the counter is done
+	static void Wait(const JobCounter& counter);
+
+	// splits [0, count) into ranges of at least minRange, about four per worker, and runs func(begin, end) on
+	// each. the calling thread runs the first range and returns once every range is done. the first exception
+	// thrown by func is rethrown here. runs inline before Init
+	template<class Func>
+	static void ParallelFor(uint32_t count, uint32_t minRange, Func&& func);
+
+private:
+	class Worker;
+
+	static void Submit(Job* job);
+	static void Execute(Job* job);
+	// one job from this worker's deque, the shared queue, another worker's deque or, on any worker but 0, the
+	// background queue
+	static Job* FindJob(uint32_t workerIndex);
+	static Job* PopQueue(std::deque<Job*>& jobs, std::atomic<uint32_t>& count);
+	static void WorkerLoop(uint32_t workerIndex);
+	static bool HasWork();
+	static void WakeWorkers();
+
+	static std::vector<std::unique_ptr<Worker>> m_Workers;
+	static std::atomic<bool> m_Running;
+
+	static std::mutex m_SharedMutex;
+	static std::deque<Job*> m_SharedJobs;
+	static std::atomic<uint32_t> m_SharedCount;
+	// same lock as the shared queue
+	static std::deque<Job*> m_BackgroundJobs;
+	static std::atomic<uint32_t> m_BackgroundCount;
+
+	// same sleep protocol as the console, submitters only touch the wake counter when someone is asleep
+	static std::atomic<uint32_t> m_Sleeping;
+	static std::atomic<uint32_t> m_WakeCounter;
+};
+
+template<class Func>
+void JobSystem::ParallelFor(uint32_t count, uint32_t minRange, Func&& func)
+{
+	if (count == 0)
+		return;
+
+	const uint32_t workers = std::max(1u, GetWorkerCount());
+	const uint32_t rangeSize = std::max({ 1u, minRange, (count + workers * 4 - 1) / (workers * 4) });
+	const uint32_t rangeCount = (count + rangeSize - 1) / rangeSize;
+
+	if (rangeCount == 1 || !IsInitialized())
+	{
+		func(0u, count);
+		return;
+	}
+
+	JobCounter counter;
+	std::exception_ptr error;
+	std::atomic<bool> failed = false;
+
+	const auto runRange = [&](uint32_t begin, uint32_t end) {
+		try
+		{
+			func(begin, end);
+		}
+		catch (...)
+		{
+			if (!failed.exchange(true))
+				error = std::current_exception();
+		}
+	};
+
+	// the first range is kept for the calling thread
+	for (uint32_t range = 1; range < rangeCount; range++)
+	{
+		const uint32_t begin = range * rangeSize;
+		const uint32_t end = std::min(count, begin + rangeSize);
+		Run([&runRange, begin, end] { runRange(begin, end); }, &counter);
+	}
+
+	runRange(0, std::min(count, rangeSize));
+	Wait(counter);
+
+	if (error)
+		std::rethrow_exception(error);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// levels share their order with ConsoleMessage::Type, Off only exists as a filter value
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+enum class LogCategory : uint8_t
+{
+    General,
+    Render,
+    Vulkan,
+    Validation,
+    Sim,
+    Path,
+    IO,
+    Count
+};
+
+inline std::string_view GetCategoryName(LogCategory category)
+{
+    switch (category)
+    {
+    case LogCategory::General:
+        return "general";
+    case LogCategory::Render:
+        return "render";
+    case LogCategory::Vulkan:
+        return "vulkan";
+    case LogCategory::Validation:
+        return "validation";
+    case LogCategory::Sim:
+        return "sim";
+    case LogCategory::Path:
+        return "path";
+    case LogCategory::IO:
+        return "io";
+    default:
+        return "unknown";
+    }
+}
+
+inline std::optional<LogCategory> ParseCategory(std::string_view name)
+{
+    for (uint8_t i = 0; i < static_cast<uint8_t>(LogCategory::Count); i++)
+    {
+        if (GetCategoryName(static_cast<LogCategory>(i)) == name)
+            return static_cast<LogCategory>(i);
+    }
+    return std::nullopt;
+}
+
+inline std::optional<LogLevel> ParseLevel(std::string_view name)
+{
+    if (name == "debug")
+        return LogLevel::Debug;
+    if (name == "info")
+        return LogLevel::Info;
+    if (name == "warning")
+        return LogLevel::Warning;
+    if (name == "error")
+        return LogLevel::Error;
+    if (name == "off")
+        return LogLevel::Off;
+    return std::nullopt;
+}
@@ -0,0 +1,228 @@
+#include "LogSink.hpp"
+#include "Console.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::string_view GetLevelName(ConsoleMessage::Type type)
+{
+    switch (type)
+    {
+    case ConsoleMessage::Type::Debug:
+        return "Debug";
+    case ConsoleMessage::Type::Info:
+        return "Info";
+    case ConsoleMessage::Type::Warning:
+        return "Warning";
+    case ConsoleMessage::Type::Error:
+        return "Error";
+    }
+    return "";
+}
+
+std::string_view GetLevelColor(ConsoleMessage::Type type)
+{
+    switch (type)
+    {
+    case ConsoleMessage::Type::Debug:
+        return "\033[32m";
+    case ConsoleMessage::Type::Info:
+        return "\033[36m";
+    case ConsoleMessage::Type::Warning:
+        return "\033[33m";
+    case ConsoleMessage::Type::Error:
+        return "\033[31m";
+    }
+    return "";
+}
+
+constexpr std::string_view resetColor = "\033[0m";
+
+// loops because a single write may be cut short (pipes, signals)
+void WriteStdout(std::string_view data)
+{
+#ifdef WIN32
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    while (!data.empty())
+    {
+        DWORD written = 0;
+        if (!WriteFile(output, data.data(), static_cast<DWORD>(data.size()), &written, nullptr) || written == 0)
+            return;
+        data.remove_prefix(written);
+    }
+#else
+    while (!data.empty())
+    {
+        const ssize_t written = write(STDOUT_FILENO, data.data(), data.size());
+        if (written <= 0)
+            return;
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+#endif
+}
+} // namespace
+
+void LogSink::AppendMessage(std::string& out, const ConsoleMessage& message, bool color)
+{
+    out += '(';
+    out += message.GetTime();
+    out += ") [";
+    if (color)
+        out += GetLevelColor(message.type);
+    out += GetLevelName(message.type);
+    if (color)
+        out += resetColor;
+    out += "] ";
+    if (message.category != LogCategory::General)
+    {
+        out += '[';
+        out += GetCategoryName(message.category);
+        out += "] ";
+    }
+    out += message.GetText();
+    if (message.truncated)
+        out += "...";
+    out += '\n';
+}
+
+TerminalSink::TerminalSink()
+{
+#ifdef WIN32
+    // the colors are plain escape sequences so the batch stays one write, which needs VT processing on windows
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    m_Color = GetConsoleMode(output, &mode) && SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#else
+    m_Color = isatty(STDOUT_FILENO);
+#endif
+    m_Buffer.reserve(Console::BatchSize * 128);
+}
+
+void TerminalSink::Write(std::span<const ConsoleMessage> messages)
+{
+    m_Buffer.clear();
+    for (const ConsoleMessage& message : messages)
+        AppendMessage(m_Buffer, message, m_Color);
+
+    // anything the rest of the program printed through stdio goes out first
+    fflush(stdout);
+    WriteStdout(m_Buffer);
+}
+
+RotatingFileSink::RotatingFileSink(std::filesystem::path path, uint64_t maxFileSize, uint32_t maxFiles, std::chrono::milliseconds syncInterval)
+    : m_Path(std::move(path)), m_MaxFileSize(maxFileSize), m_MaxFiles(std::max(maxFiles, 1u)), m_SyncInterval(syncInterval),
+      m_LastSync(std::chrono::steady_clock::now())
+{
+    m_Buffer.reserve(BufferSize + Console::BatchSize * 128);
+    Open();
+}
+
+RotatingFileSink::~RotatingFileSink()
+{
+    WriteBuffer();
+    if (m_File == nullptr)
+        return;
+
+    if (m_SyncInterval.count() > 0)
+        Sync();
+    fclose(m_File);
+}
+
+void RotatingFileSink::Write(std::span<const ConsoleMessage> messages)
+{
+    for (const ConsoleMessage& message : messages)
+        AppendMessage(m_Buffer, message, false);
+
+    // the console only flushes when it runs dry, which it may not do for a long time under load
+    if (m_Buffer.size() >= BufferSize || IsSyncDue())
+        WriteBuffer();
+}
+
+void RotatingFileSink::Flush()
+{
+    WriteBuffer();
+}
+
+void RotatingFileSink::Open()
+{
+    m_File = fopen(m_Path.string().c_str(), "ab");
+    if (m_File == nullptr)
+    {
+        fprintf(stderr, "RotatingFileSink - failed to open %s\n", m_Path.string().c_str());
+        return;
+    }
+
+    // buffering is done here, so every fwrite is one write to the file
+    setvbuf(m_File, nullptr, _IONBF, 0);
+
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(m_Path, error);
+    m_FileSize = error ? 0 : size;
+}
+
+void RotatingFileSink::Rotate()
+{
+    if (m_SyncInterval.count() > 0)
+        Sync();
+    fclose(m_File);
+    m_File = nullptr;
+
+    // renames replace existing files, so the oldest is dropped by path.(maxFiles - 1) moving onto it
+    std::error_code error;
+    const std::string base = m_Path.string();
+    for (uint32_t i = m_MaxFiles - 1; i > 0; i--)
+    {
+        const std::filesystem::path from = i == 1 ? m_Path : std::filesystem::path(base + "." + std::to_string(i - 1));
+        std::filesystem::rename(from, base + "." + std::to_string(i), error);
+    }
+    if (m_MaxFiles == 1)
+        std::filesystem::remove(m_Path, error);
+
+    Open();
+    m_FileSize = 0;
+}
+
+void RotatingFileSink::WriteBuffer()
+{
+    if (!m_Buffer.empty())
+    {
+        if (m_File != nullptr && m_FileSize > 0 && m_FileSize + m_Buffer.size() > m_MaxFileSize)
+            Rotate();
+
+        if (m_File != nullptr)
+        {
+            m_FileSize += fwrite(m_Buffer.data(), 1, m_Buffer.size(), m_File);
+            m_Unsynced = true;
+        }
+
+        m_Buffer.clear();
+    }
+
+    if (m_Unsynced && IsSyncDue())
+        Sync();
+}
+
+bool RotatingFileSink::IsSyncDue() const
+{
+    return m_SyncInterval.count() > 0 && std::chrono::steady_clock::now() - m_LastSync >= m_SyncInterval;
+}
+
+void RotatingFileSink::Sync()
+{
+#ifdef WIN32
+    _commit(_fileno(m_File));
+#else
+    fsync(fileno(m_File));
+#endif
+    m_Unsynced = false;
+    m_LastSync = std::chrono::steady_clock::now();
+}
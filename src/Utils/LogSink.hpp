@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <string>
+
+struct ConsoleMessage;
+
+// receives every message the console thread drains, always called from the console thread
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+
+    // one call per drained batch
+    virtual void Write(std::span<const ConsoleMessage> messages) = 0;
+    // called once the console runs out of messages and again before it shuts down
+    virtual void Flush() {}
+
+protected:
+    // "(time) [Level] [category] text\n", with ANSI colors around the level when color is set
+    static void AppendMessage(std::string& out, const ConsoleMessage& message, bool color);
+};
+
+// formats a whole batch into one buffer and hands it to stdout with a single write
+class TerminalSink : public LogSink
+{
+public:
+    TerminalSink();
+
+    void Write(std::span<const ConsoleMessage> messages) override;
+
+private:
+    std::string m_Buffer;
+    bool m_Color = true;
+};
+
+// appends to path, once a file would pass maxFileSize it becomes path.1 (path.1 becomes path.2 and so on, keeping
+// maxFiles). rotation happens between buffer writes, so a file that starts empty can overshoot by up to one buffer
+class RotatingFileSink : public LogSink
+{
+public:
+    // bytes collected before they are written out, flushing writes whatever is pending early
+    static constexpr size_t BufferSize = 64 * 1024;
+
+    // a zero sync interval leaves syncing to the OS, otherwise new lines are written and fsynced
+    // once that long has passed since the last sync, even while the console never runs dry
+    RotatingFileSink(std::filesystem::path path, uint64_t maxFileSize = 16 * 1024 * 1024, uint32_t maxFiles = 4,
+                     std::chrono::milliseconds syncInterval = std::chrono::milliseconds(0));
+    ~RotatingFileSink() override;
+
+    RotatingFileSink(const RotatingFileSink&) = delete;
+    RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+
+    bool IsOpen() const { return m_File != nullptr; }
+
+    void Write(std::span<const ConsoleMessage> messages) override;
+    void Flush() override;
+
+private:
+    void Open();
+    void Rotate();
+    // also syncs once the sync interval has passed
+    void WriteBuffer();
+    bool IsSyncDue() const;
+    void Sync();
+
+    std::filesystem::path m_Path;
+    uint64_t m_MaxFileSize;
+    uint32_t m_MaxFiles;
+    std::chrono::milliseconds m_SyncInterval;
+
+    FILE* m_File = nullptr;
+    uint64_t m_FileSize = 0;
+    std::string m_Buffer;
+    bool m_Unsynced = false;
+    std::chrono::steady_clock::time_point m_LastSync;
+};
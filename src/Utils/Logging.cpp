@@ -1,8 +1,23 @@
 #include "Logging.hpp"
 
+#include <utility>
+
+namespace
+{
+// constant initialized, so logging from other static initializers already sees the default levels
+template<size_t ... Indices>
+constexpr std::array<std::atomic<uint8_t>, sizeof...(Indices)> MakeDefaultLevels(std::index_sequence<Indices...>)
+{
+    return { ((void) Indices, static_cast<uint8_t>(LOG_MIN_LEVEL))... };
+}
+} // namespace
+
 std::weak_ptr<Console> Logging::m_Console;
+std::atomic<bool> Logging::m_BinaryMode = false;
+std::array<std::atomic<uint8_t>, static_cast<size_t>(LogCategory::Count)> Logging::m_CategoryLevels =
+    MakeDefaultLevels(std::make_index_sequence<static_cast<size_t>(LogCategory::Count)>());
 
-std::string Logging::GetCurrentTime()
+void Logging::GetCurrentTime(char (&buffer)[ConsoleMessage::TimeLength])
 {
 	const time_t now = std::time(nullptr);
 	std::tm localTime;
@@ -14,10 +29,49 @@ std::string Logging::GetCurrentTime()
 
 	const auto format = "%H:%M:%S";
 
-	char buffer[80];
-	(void) std::strftime(buffer, sizeof(buffer), format, &localTime);
+	if (std::strftime(buffer, sizeof(buffer), format, &localTime) == 0)
+		buffer[0] = '\0';
+}
+
+void Logging::SetCategoryLevel(LogCategory category, LogLevel level)
+{
+    m_CategoryLevels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+void Logging::SetLevel(LogLevel level)
+{
+    for (auto& categoryLevel : m_CategoryLevels)
+        categoryLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+bool Logging::ParseLevels(std::string_view levels)
+{
+    bool valid = true;
+    while (!levels.empty())
+    {
+        const size_t comma = levels.find(',');
+        const std::string_view entry = levels.substr(0, comma);
+        levels = comma == std::string_view::npos ? std::string_view() : levels.substr(comma + 1);
+
+        const size_t equals = entry.find('=');
+        if (equals == std::string_view::npos)
+        {
+            const std::optional<LogLevel> level = ParseLevel(entry);
+            if (level.has_value())
+                SetLevel(level.value());
+            else
+                valid = false;
+            continue;
+        }
 
-	return buffer;
+        const std::optional<LogCategory> category = ParseCategory(entry.substr(0, equals));
+        const std::optional<LogLevel> level = ParseLevel(entry.substr(equals + 1));
+        if (category.has_value() && level.has_value())
+            SetCategoryLevel(category.value(), level.value());
+        else
+            valid = false;
+    }
+    return valid;
 }
 
 void Logging::Init()
@@ -1,15 +1,83 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <format>
 #include <print>
+#include <string_view>
+#include <type_traits>
 
+#include "BinaryLog.hpp"
 #include "Console.hpp"
+#include "LogCategory.hpp"
+
+// calls below this level are compiled out entirely by the LOG_* macros, 0 debug, 1 info, 2 warning, 3 error
+#ifndef LOG_MIN_LEVEL
+#ifdef DEBUG
+#define LOG_MIN_LEVEL 0
+#else
+#define LOG_MIN_LEVEL 1
+#endif
+#endif
+
+// the category's runtime level is checked before any argument is evaluated
+#define LOG_AT(category, level, ...)                          \
+    do                                                        \
+    {                                                         \
+        if (Logging::IsEnabled(category, level))              \
+            Logging::Log(category, level, __VA_ARGS__);       \
+    } while (0)
+
+#if LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(category, ...) LOG_AT(category, LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void) 0)
+#endif
+
+#if LOG_MIN_LEVEL <= 1
+#define LOG_INFO(category, ...) LOG_AT(category, LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void) 0)
+#endif
+
+#if LOG_MIN_LEVEL <= 2
+#define LOG_WARNING(category, ...) LOG_AT(category, LogLevel::Warning, __VA_ARGS__)
+#else
+#define LOG_WARNING(category, ...) ((void) 0)
+#endif
+
+#if LOG_MIN_LEVEL <= 3
+#define LOG_ERROR(category, ...) LOG_AT(category, LogLevel::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) ((void) 0)
+#endif
 
 class Logging
 {
 public:
     static void Init();
-        
+
+    // records arguments raw and leaves all formatting to the console thread, calls with arguments that
+    // can't be stored as bytes (see BinaryLog::IsEncodable) are still formatted on the caller
+    static void SetBinaryMode(bool enabled) { m_BinaryMode.store(enabled, std::memory_order_relaxed); }
+    static bool IsBinaryMode() { return m_BinaryMode.load(std::memory_order_relaxed); }
+
+    static bool IsEnabled(LogCategory category, LogLevel level)
+    {
+        return static_cast<uint8_t>(level) >= m_CategoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    static void SetCategoryLevel(LogCategory category, LogLevel level);
+    static void SetLevel(LogLevel level);
+    // comma separated category=level pairs, a bare level applies to every category, e.g. "info,render=debug,path=off"
+    static bool ParseLevels(std::string_view levels);
+
+    // prefer the LOG_* macros, they skip argument evaluation when the category is filtered out
+    template<class ... Args>
+    static void Log(LogCategory category, LogLevel level, std::format_string<Args...> format, Args&& ... args);
+
+    // general category
     template<class ... Args>
     static void Debug(std::format_string<Args...> format, Args&& ... args);
 
@@ -23,42 +91,66 @@ public:
     static void Error(std::format_string<Args...> format, Args&& ... args);
     
 private:
-    static std::string GetCurrentTime();
+    static void GetCurrentTime(char (&buffer)[ConsoleMessage::TimeLength]);
     static std::weak_ptr<Console> m_Console;
+    static std::atomic<bool> m_BinaryMode;
+    static std::array<std::atomic<uint8_t>, static_cast<size_t>(LogCategory::Count)> m_CategoryLevels;
 };
 
 template<class ... Args>
 void Logging::Debug(std::format_string<Args...> format, Args&& ... args)
 {
-    if (auto console = m_Console.lock())
-    {
-        console->QueueMessage(std::format(format, std::forward<Args>(args)...), ConsoleMessage::Type::Debug, GetCurrentTime());
-    }
+    if (IsEnabled(LogCategory::General, LogLevel::Debug))
+        Log(LogCategory::General, LogLevel::Debug, format, std::forward<Args>(args)...);
 }
 
 template<class ... Args>
 void Logging::Info(std::format_string<Args...> format, Args&& ... args)
 {
-    if (auto console = m_Console.lock())
-    {
-        console->QueueMessage(std::format(format, std::forward<Args>(args)...), ConsoleMessage::Type::Info, GetCurrentTime());
-    }
+    if (IsEnabled(LogCategory::General, LogLevel::Info))
+        Log(LogCategory::General, LogLevel::Info, format, std::forward<Args>(args)...);
 }
 
 template<class ... Args>
 void Logging::Warning(std::format_string<Args...> format, Args&& ... args)
 {
-    if (auto console = m_Console.lock())
-    {
-        console->QueueMessage(std::format(format, std::forward<Args>(args)...), ConsoleMessage::Type::Warning, GetCurrentTime());
-    }
+    if (IsEnabled(LogCategory::General, LogLevel::Warning))
+        Log(LogCategory::General, LogLevel::Warning, format, std::forward<Args>(args)...);
 }
 
 template <class... Args>
 void Logging::Error(std::format_string<Args...> format, Args&&... args)
 {
+    if (IsEnabled(LogCategory::General, LogLevel::Error))
+        Log(LogCategory::General, LogLevel::Error, format, std::forward<Args>(args)...);
+}
+
+template<class ... Args>
+void Logging::Log(LogCategory category, LogLevel level, std::format_string<Args...> format, Args&& ... args)
+{
+    static_assert(static_cast<uint8_t>(LogLevel::Error) == static_cast<uint8_t>(ConsoleMessage::Type::Error));
+    const auto type = static_cast<ConsoleMessage::Type>(level);
+
     if (auto console = m_Console.lock())
     {
-        console->QueueMessage(std::format(format, std::forward<Args>(args)...), ConsoleMessage::Type::Error, GetCurrentTime());
+        if constexpr ((BinaryLog::IsEncodable<std::decay_t<Args>> && ...))
+        {
+            if (m_BinaryMode.load(std::memory_order_relaxed))
+            {
+                if (BinaryLog::Write<std::decay_t<Args>...>(type, category, format.get(), args...))
+                    console->Wake();
+                return;
+            }
+        }
+
+        // formatted straight into a stack buffer, the queue copies it into a preallocated slot
+        char buffer[ConsoleMessage::MaxLength];
+        const auto result = std::format_to_n(buffer, sizeof(buffer), format, std::forward<Args>(args)...);
+        const size_t length = std::min(static_cast<size_t>(result.size), sizeof(buffer));
+
+        char time[ConsoleMessage::TimeLength];
+        GetCurrentTime(time);
+
+        console->QueueMessage(std::string_view(buffer, length), type, category, time, length < static_cast<size_t>(result.size));
     }
 }
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// bounded lock free multi producer single consumer ring. every slot is allocated up front and carries a sequence
+// number, producers claim a slot with one compare exchange on the tail and publish it by bumping the sequence, so
+// pushing never allocates or takes a lock and a full queue is reported instead of waited on
+template<class T>
+class MessageQueue
+{
+public:
+	// capacity is rounded up to a power of two
+	explicit MessageQueue(size_t capacity)
+	{
+		const size_t size = std::bit_ceil(capacity < 2 ? size_t(2) : capacity);
+		m_Mask = size - 1;
+		m_Slots = std::make_unique<Slot[]>(size);
+
+		for (size_t i = 0; i < size; i++)
+			m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	MessageQueue(const MessageQueue&) = delete;
+	MessageQueue& operator=(const MessageQueue&) = delete;
+
+	// write(T&) fills the claimed slot in place, returns false when the queue is full
+	template<class Func>
+	bool TryPush(Func&& write)
+	{
+		size_t position = m_Tail.load(std::memory_order_relaxed);
+		Slot* slot = nullptr;
+
+		for (;;)
+		{
+			slot = &m_Slots[position & m_Mask];
+			const size_t sequence = slot->Sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				if (m_Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				// the consumer hasn't freed this slot yet
+				return false;
+			}
+			else
+			{
+				position = m_Tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		write(slot->Value);
+		slot->Sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only, read(const T&) sees the oldest published slot, returns false when the queue is empty
+	template<class Func>
+	bool TryPop(Func&& read)
+	{
+		Slot& slot = m_Slots[m_Head & m_Mask];
+		if (slot.Sequence.load(std::memory_order_acquire) != m_Head + 1)
+			return false;
+
+		read(slot.Value);
+		slot.Sequence.store(m_Head + m_Mask + 1, std::memory_order_release);
+		m_Head++;
+		return true;
+	}
+
+	// consumer only
+	bool IsEmpty() const { return m_Slots[m_Head & m_Mask].Sequence.load(std::memory_order_acquire) != m_Head + 1; }
+
+	size_t GetCapacity() const { return m_Mask + 1; }
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> Sequence;
+		T Value;
+	};
+
+	std::unique_ptr<Slot[]> m_Slots;
+	size_t m_Mask = 0;
+
+	// producers and the consumer each get their own cache line
+	alignas(64) std::atomic<size_t> m_Tail = 0;
+	alignas(64) size_t m_Head = 0;
+};
@@ -1,5 +1,7 @@
 #include "Time.hpp"
 
+#include <algorithm>
+
 using namespace std::chrono;
 
 Time::TimeSince::TimeSince()
@@ -9,15 +11,16 @@ Time::TimeSince::TimeSince()
 
 Time::TimeSince::TimeSince(double since)
 {
-    timePoint = time_point_cast<microseconds>(high_resolution_clock::now() - duration_cast<microseconds>(duration<float>(since)));
+    timePoint = time_point_cast<microseconds>(high_resolution_clock::now() - duration_cast<microseconds>(duration<double>(since)));
 }
 
 Time::TimeSince::operator double() const
 {
-    return static_cast<float>(duration_cast<microseconds>(high_resolution_clock::now() - timePoint).count()) / 10e5f;
+    return duration<double>(high_resolution_clock::now() - timePoint).count();
 }
 
-float Time::timeScale = 1.f;
+uint32_t Time::timeScale = 1;
+uint32_t Time::maxTicksPerFrame = 32;
 
 high_resolution_clock::time_point Time::appStart;
 high_resolution_clock::time_point Time::curFrame;
@@ -26,11 +29,21 @@ high_resolution_clock::time_point Time::lastFrame;
 float Time::time = 0.f;
 float Time::deltaTime = 0.f;
 
+nanoseconds Time::accumulator = nanoseconds(0);
+uint32_t Time::pendingTicks = 0;
+uint64_t Time::tick = 0;
+uint64_t Time::droppedTicks = 0;
+
 void Time::Init()
 {
     appStart = high_resolution_clock::now();
     curFrame = appStart;
     lastFrame = appStart;
+
+    accumulator = nanoseconds(0);
+    pendingTicks = 0;
+    tick = 0;
+    droppedTicks = 0;
 }
 
 void Time::Update()
@@ -47,13 +60,28 @@ void Time::CalculateCurrentFrame()
 
 void Time::CalculateTime()
 {
-    time = static_cast<float>(duration_cast<milliseconds>(curFrame - appStart).count()) / 10e3f;
+    time = duration<float>(curFrame - appStart).count();
 }
 
 void Time::CalculateDeltaTime()
 {
-    deltaTime = static_cast<float>(duration_cast<microseconds>(curFrame - lastFrame).count()) / 10e5f;
+    const nanoseconds frameTime = duration_cast<nanoseconds>(curFrame - lastFrame);
+    deltaTime = duration<float>(frameTime).count();
     lastFrame = curFrame;
+
+    // speeding up multiplies the time fed to the accumulator, so it turns into more ticks of the same length
+    accumulator += frameTime * timeScale;
+    CalculateTicks();
+}
+
+void Time::CalculateTicks()
+{
+    // ticks left over from a frame that didn't consume them still run
+    const uint64_t ticks = pendingTicks + static_cast<uint64_t>(accumulator / TickLength);
+    accumulator %= TickLength;
+
+    pendingTicks = static_cast<uint32_t>(std::min<uint64_t>(ticks, maxTicksPerFrame));
+    droppedTicks += ticks - pendingTicks;
 }
 
 float Time::GetTime()
@@ -63,5 +91,40 @@ float Time::GetTime()
 
 float Time::GetDeltaTime()
 {
-    return deltaTime * timeScale;
+    return deltaTime * static_cast<float>(timeScale);
+}
+
+bool Time::ConsumeTick()
+{
+    if (pendingTicks == 0)
+        return false;
+
+    pendingTicks--;
+    tick++;
+    return true;
+}
+
+uint32_t Time::GetPendingTicks()
+{
+    return pendingTicks;
+}
+
+uint64_t Time::GetTick()
+{
+    return tick;
+}
+
+double Time::GetSimTime()
+{
+    return duration<double>(TickLength * tick).count();
+}
+
+float Time::GetInterpolationAlpha()
+{
+    return static_cast<float>(accumulator.count()) / static_cast<float>(TickLength.count());
+}
+
+uint64_t Time::GetDroppedTicks()
+{
+    return droppedTicks;
 }
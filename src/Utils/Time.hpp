@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 class Time
 {
@@ -18,7 +19,14 @@ public:
     };
 
 public:
-    static float timeScale;
+    // the simulation only ever advances in whole ticks of TickLength, independent of the frame rate
+    static constexpr uint32_t TicksPerSecond = 60;
+    static constexpr std::chrono::nanoseconds TickLength = std::chrono::nanoseconds(std::chrono::seconds(1)) / TicksPerSecond;
+
+    // sim ticks per tick of real time, 3 runs three ticks where 1 runs one. 0 pauses the simulation
+    static uint32_t timeScale;
+    // ticks a single frame may run, a longer stall is dropped instead of being caught up over the following frames
+    static uint32_t maxTicksPerFrame;
 
     static void Init();
     static void Update();
@@ -26,10 +34,22 @@ public:
     static float GetTime();
     static float GetDeltaTime();
 
+    // call until false after Update, each true is one simulation step
+    static bool ConsumeTick();
+    static uint32_t GetPendingTicks();
+    // ticks run since Init
+    static uint64_t GetTick();
+    static double GetSimTime();
+    // how far the next tick is, for interpolating between the last two simulated states when rendering
+    static float GetInterpolationAlpha();
+    // ticks dropped by maxTicksPerFrame since Init
+    static uint64_t GetDroppedTicks();
+
 private:
     static void CalculateCurrentFrame();
     static void CalculateTime();
     static void CalculateDeltaTime();
+    static void CalculateTicks();
 
     static std::chrono::high_resolution_clock::time_point appStart;
     static std::chrono::high_resolution_clock::time_point curFrame;
@@ -37,4 +57,10 @@ private:
 
     static float time;
     static float deltaTime;
+
+    // scaled real time not yet turned into ticks, always less than one TickLength after Update
+    static std::chrono::nanoseconds accumulator;
+    static uint32_t pendingTicks;
+    static uint64_t tick;
+    static uint64_t droppedTicks;
 };
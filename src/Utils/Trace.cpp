@@ -0,0 +1,203 @@
+#include "Trace.hpp"
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::atomic<bool> Trace::m_Enabled = false;
+
+class Trace::ThreadBuffer
+{
+public:
+    struct Event
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    explicit ThreadBuffer(uint32_t id)
+        : Id(id), m_Events(std::make_unique<Event[]>(ThreadBufferEvents))
+    {
+    }
+
+    void Record(const char* name, uint64_t start, uint64_t end)
+    {
+        // pairs with Stop, either it sees the writing flag and waits or we see that tracing was stopped
+        m_Writing.store(true);
+        if (Trace::m_Enabled.load())
+        {
+            const uint64_t count = m_Count.load(std::memory_order_relaxed);
+            m_Events[count % ThreadBufferEvents] = { name, start, end };
+            m_Count.store(count + 1, std::memory_order_relaxed);
+        }
+        m_Writing.store(false, std::memory_order_release);
+    }
+
+    void WaitForWriter() const
+    {
+        while (m_Writing.load())
+            std::this_thread::yield();
+    }
+
+    // only while stopped
+    void Clear() { m_Count.store(0, std::memory_order_relaxed); }
+
+    template<class Func>
+    void ForEachEvent(Func&& func) const
+    {
+        const uint64_t count = m_Count.load(std::memory_order_relaxed);
+        const uint64_t first = count > ThreadBufferEvents ? count - ThreadBufferEvents : 0;
+        for (uint64_t i = first; i < count; i++)
+            func(m_Events[i % ThreadBufferEvents]);
+    }
+
+    const uint32_t Id;
+    std::atomic<const char*> Name = nullptr;
+    // set when the owning thread exits, the events stay around until the next capture starts
+    std::atomic<bool> Abandoned = false;
+
+private:
+    std::unique_ptr<Event[]> m_Events;
+    std::atomic<uint64_t> m_Count = 0;
+    std::atomic<bool> m_Writing = false;
+};
+
+namespace
+{
+struct Registry
+{
+    std::mutex Mutex;
+    std::vector<std::shared_ptr<Trace::ThreadBuffer>> Buffers;
+    uint32_t NextId = 1;
+    uint64_t StartTime = 0;
+};
+
+Registry& GetRegistry()
+{
+    // leaked on purpose, threads can still exit (and touch their buffer) while statics are being destroyed
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+struct ThreadBufferHandle
+{
+    ThreadBufferHandle()
+    {
+        Registry& registry = GetRegistry();
+        std::scoped_lock lock(registry.Mutex);
+        Buffer = std::make_shared<Trace::ThreadBuffer>(registry.NextId++);
+        registry.Buffers.push_back(Buffer);
+    }
+
+    ~ThreadBufferHandle() { Buffer->Abandoned.store(true, std::memory_order_release); }
+
+    std::shared_ptr<Trace::ThreadBuffer> Buffer;
+};
+
+thread_local ThreadBufferHandle t_Buffer;
+
+void AppendEscaped(std::string& out, std::string_view text)
+{
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+}
+} // namespace
+
+void Trace::Start()
+{
+    Stop();
+
+    Registry& registry = GetRegistry();
+    {
+        std::scoped_lock lock(registry.Mutex);
+        std::erase_if(registry.Buffers, [](const auto& buffer) { return buffer->Abandoned.load(std::memory_order_acquire); });
+        for (const auto& buffer : registry.Buffers)
+            buffer->Clear();
+        registry.StartTime = Now();
+    }
+
+    m_Enabled.store(true);
+}
+
+void Trace::Stop()
+{
+    m_Enabled.store(false);
+
+    // a zone that saw tracing enabled finishes its write before the buffers are read or cleared
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock(registry.Mutex);
+    for (const auto& buffer : registry.Buffers)
+        buffer->WaitForWriter();
+}
+
+void Trace::SetThreadName(const char* name)
+{
+    t_Buffer.Buffer->Name.store(name, std::memory_order_relaxed);
+}
+
+uint64_t Trace::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Trace::Record(const char* name, uint64_t start, uint64_t end)
+{
+    t_Buffer.Buffer->Record(name, start, end);
+}
+
+bool Trace::ExportChromeJson(const std::filesystem::path& path)
+{
+    Stop();
+
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock(registry.Mutex);
+
+    const uint64_t startTime = registry.StartTime;
+    std::string json = "{\"traceEvents\":[\n";
+    auto out = std::back_inserter(json);
+    bool first = true;
+
+    for (const auto& buffer : registry.Buffers)
+    {
+        if (const char* name = buffer->Name.load(std::memory_order_relaxed))
+        {
+            json += first ? "" : ",\n";
+            first = false;
+            json += std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"", buffer->Id);
+            AppendEscaped(json, name);
+            json += "\"}}";
+        }
+
+        buffer->ForEachEvent([&](const ThreadBuffer::Event& event) {
+            // a zone that was already open when the capture restarted
+            if (event.start < startTime)
+                return;
+
+            // complete events, timestamps in microseconds from the start of the capture
+            json += first ? "" : ",\n";
+            first = false;
+            json += "{\"name\":\"";
+            AppendEscaped(json, event.name);
+            std::format_to(out, "\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", buffer->Id,
+                           static_cast<double>(event.start - startTime) / 1000.0, static_cast<double>(event.end - event.start) / 1000.0);
+        });
+    }
+
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    file.close();
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// 0 removes every TRACE_* macro at compile time, otherwise zones cost a relaxed load while tracing is stopped
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#if TRACE_ENABLED
+// name has to outlive the trace (a string literal)
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) Trace::SetThreadName(name)
+#else
+#define TRACE_ZONE(name) ((void) 0)
+#define TRACE_THREAD_NAME(name) ((void) 0)
+#endif
+
+// cpu zone capture. every thread records completed zones into its own ring (the newest ThreadBufferEvents are
+// kept), nothing is shared between threads until the trace is exported
+class Trace
+{
+public:
+    static constexpr size_t ThreadBufferEvents = 64 * 1024;
+
+    // discards anything recorded by an earlier capture
+    static void Start();
+    static void Stop();
+    static bool IsEnabled() { return m_Enabled.load(std::memory_order_relaxed); }
+
+    // shown as the thread's track name, name has to outlive the trace
+    static void SetThreadName(const char* name);
+
+    // chrome trace event json, opens in chrome://tracing and ui.perfetto.dev. stops the capture first
+    static bool ExportChromeJson(const std::filesystem::path& path);
+
+    static uint64_t Now();
+    static void Record(const char* name, uint64_t start, uint64_t end);
+
+    // per thread event storage, public only so the thread local owning it can name it
+    class ThreadBuffer;
+
+private:
+    static std::atomic<bool> m_Enabled;
+};
+
+class TraceZone
+{
+public:
+    explicit TraceZone(const char* name)
+    {
+        if (Trace::IsEnabled())
+        {
+            m_Name = name;
+            m_Start = Trace::Now();
+        }
+    }
+
+    ~TraceZone()
+    {
+        if (m_Name != nullptr)
+            Trace::Record(m_Name, m_Start, Trace::Now());
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* m_Name = nullptr;
+    uint64_t m_Start = 0;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// bounded Chase-Lev deque (the C11 formulation by Le, Pop, Cohen and Zappa Nardelli). the owning thread pushes and
+// pops at the bottom without any read-modify-write unless it races a thief for the last element, every other
+// thread steals from the top with one compare exchange
+template<class T>
+class WorkStealingDeque
+{
+public:
+	// capacity is rounded up to a power of two
+	explicit WorkStealingDeque(size_t capacity)
+	{
+		const size_t size = std::bit_ceil(capacity < 2 ? size_t(2) : capacity);
+		m_Mask = static_cast<int64_t>(size) - 1;
+		m_Items = std::make_unique<std::atomic<T*>[]>(size);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// owner only, returns false when full
+	bool Push(T* item)
+	{
+		const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+		const int64_t top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top > m_Mask)
+			return false;
+
+		m_Items[bottom & m_Mask].store(item, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	// owner only, newest first
+	T* Pop()
+	{
+		const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T* item = m_Items[bottom & m_Mask].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// last element, whoever moves top first gets it
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				item = nullptr;
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	// any thread, oldest first. nullptr when empty or when another thread won the race
+	T* Steal()
+	{
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return nullptr;
+
+		T* item = m_Items[top & m_Mask].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return item;
+	}
+
+	bool IsEmpty() const { return m_Bottom.load(std::memory_order_acquire) <= m_Top.load(std::memory_order_acquire); }
+
+private:
+	std::unique_ptr<std::atomic<T*>[]> m_Items;
+	int64_t m_Mask = 0;
+
+	alignas(64) std::atomic<int64_t> m_Top = 0;
+	alignas(64) std::atomic<int64_t> m_Bottom = 0;
+};
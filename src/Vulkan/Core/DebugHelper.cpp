@@ -3,16 +3,15 @@
 
 #include <unordered_map>
 
-LogLevel DebugHelper::m_validationLogLevel = LogLevel::eTrace;
 const std::vector<const char*> DebugHelper::m_validationLayers = { "VK_LAYER_KHRONOS_validation" };
 
 namespace
 {
 std::unordered_map<VkDebugUtilsMessageSeverityFlagBitsEXT, LogLevel> severityMap = {
-	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT, LogLevel::eTrace },
-	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT, LogLevel::eInfo },
-	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT, LogLevel::eWarn },
-	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT, LogLevel::eErr },
+	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT, LogLevel::Debug },
+	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT, LogLevel::Info },
+	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT, LogLevel::Warning },
+	{ VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT, LogLevel::Error },
 };
 }
 
@@ -21,19 +20,8 @@ VKAPI_ATTR VkBool32 VKAPI_CALL DebugHelper::debugCallback(VkDebugUtilsMessageSev
 														  const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
 														  void* pUserData)
 {
-	auto severityLevel = severityMap[messageSeverity];
-	if (m_validationLogLevel <= severityLevel)
-	{
-		// todo: fix the logging levels
-		if (severityLevel == LogLevel::eTrace)
-			Logging::Info("validation layer:\t{}", pCallbackData->pMessage);
-		else if (severityLevel == LogLevel::eInfo)
-			Logging::Debug("validation layer:\t{}", pCallbackData->pMessage);
-		else if (severityLevel == LogLevel::eWarn)
-			Logging::Warning("validation layer:\t{}", pCallbackData->pMessage);
-		else if (severityLevel == LogLevel::eErr)
-			Logging::Error("validation layer:\t{}", pCallbackData->pMessage);
-	}
+	const LogLevel severityLevel = severityMap[messageSeverity];
+	LOG_AT(LogCategory::Validation, severityLevel, "{}", pCallbackData->pMessage);
 
 	return VK_FALSE;
 }
@@ -93,7 +81,7 @@ void DebugHelper::create(vk::Instance instance)
 
 	if (createDebugUtilsMessengerFunc == nullptr)
 	{
-		Logging::Error("could not create debug messenger, aborting");
+		LOG_ERROR(LogCategory::Vulkan, "could not create debug messenger, aborting");
 		throw std::runtime_error("could not create debug messenger");
 	}
 
@@ -103,7 +91,7 @@ void DebugHelper::create(vk::Instance instance)
 
 	if (result != VK_SUCCESS)
 	{
-		Logging::Error("could not create debug messenger, aborting");
+		LOG_ERROR(LogCategory::Vulkan, "could not create debug messenger, aborting");
 		throw std::runtime_error("could not create debug messenger");
 	}
 }
@@ -1,18 +1,10 @@
 #pragma once
 #include <vulkan/vulkan.hpp>
 
-enum class LogLevel : int
-{
-	eTrace,
-	eInfo,
-	eWarn,
-	eErr,
-};
-
 class DebugHelper
 {
 public:
-	static LogLevel m_validationLogLevel;
+	// validation output is filtered like any other log category (LogCategory::Validation)
 	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 														VkDebugUtilsMessageTypeFlagsEXT messageType,
 														const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
@@ -7,6 +7,11 @@
 #include "Vulkan/Core/Utils.h"
 #include "Utils/Logging.hpp"
 
+namespace
+{
+const char* pipelineCachePath = "pipeline_cache.bin";
+} // namespace
+
 VulkanDevice::~VulkanDevice()
 {
 }
@@ -14,13 +19,23 @@ VulkanDevice::~VulkanDevice()
 void VulkanDevice::create(vk::Instance instance, vk::SurfaceKHR surface)
 {
 	m_instance = instance;
+	m_headless = !surface;
+
+	// without a surface there is nothing to present to, so the swapchain extension is optional
+	if (!m_headless)
+		m_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
 	pickPhysicalDevice(surface);
 	createDevice(surface);
 	createAllocator();
+	m_pipelineCache.create(handle, m_physicalDevice, pipelineCachePath);
 }
 
 void VulkanDevice::destroy()
 {
+	m_pipelineCache.save();
+	m_pipelineCache.destroy();
+	vmaDestroyAllocator(m_allocator);
 	handle.destroy();
 }
 
@@ -28,7 +43,11 @@ void VulkanDevice::createDevice(vk::SurfaceKHR surface)
 {
 	const std::array<float, 1> priorities = { 1.f };
 	const vulkan_utils::QueueFamilyIndices indices = vulkan_utils::findQueueFamilies(m_physicalDevice, surface);
-	const std::unordered_set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+	std::unordered_set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value() };
+	if (indices.presentFamily.has_value())
+		uniqueQueueFamilies.insert(indices.presentFamily.value());
+	if (indices.transferFamily.has_value())
+		uniqueQueueFamilies.insert(indices.transferFamily.value());
 
 	std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
 	for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -40,10 +59,21 @@ void VulkanDevice::createDevice(vk::SurfaceKHR surface)
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	const vk::PhysicalDeviceFeatures supported = m_physicalDevice.getFeatures();
+	// statistics queries stay active while secondary command buffers execute, which needs inherited queries
+	m_pipelineStatisticsSupported = supported.pipelineStatisticsQuery && supported.inheritedQueries;
+
 	vk::PhysicalDeviceFeatures deviceFeatures;
 	deviceFeatures.setSamplerAnisotropy(true);
+	deviceFeatures.setPipelineStatisticsQuery(m_pipelineStatisticsSupported);
+	deviceFeatures.setInheritedQueries(m_pipelineStatisticsSupported);
+
+	// timeline semaphores are used to track upload completion
+	vk::PhysicalDeviceVulkan12Features vulkan12Features;
+	vulkan12Features.setTimelineSemaphore(true);
 
 	vk::DeviceCreateInfo createInfo;
+	createInfo.setPNext(&vulkan12Features);
 	createInfo.setQueueCreateInfos(queueCreateInfos);
 	createInfo.setPEnabledFeatures(&deviceFeatures);
 	createInfo.setPEnabledExtensionNames(m_extensions);
@@ -55,8 +85,17 @@ void VulkanDevice::createDevice(vk::SurfaceKHR surface)
 
 	handle = m_physicalDevice.createDevice(createInfo);
 
-	m_graphicsQueue = handle.getQueue(indices.graphicsFamily.value(), 0);
-	m_presentQueue = handle.getQueue(indices.presentFamily.value(), 0);
+	const auto queueFamilyProperties = m_physicalDevice.getQueueFamilyProperties();
+	m_timestampValidBits = queueFamilyProperties[indices.graphicsFamily.value()].timestampValidBits;
+	m_timestampPeriod = m_physicalDevice.getProperties().limits.timestampPeriod;
+
+	m_graphicsFamily = indices.graphicsFamily.value();
+	m_transferFamily = indices.transferFamily.value_or(m_graphicsFamily);
+
+	m_graphicsQueue = handle.getQueue(m_graphicsFamily, 0);
+	m_transferQueue = handle.getQueue(m_transferFamily, 0);
+	if (indices.presentFamily.has_value())
+		m_presentQueue = handle.getQueue(indices.presentFamily.value(), 0);
 }
 
 
@@ -70,7 +109,7 @@ void VulkanDevice::VulkanDevice::createAllocator()
 	createInfo.physicalDevice = m_physicalDevice;
 	createInfo.device = handle;
 	createInfo.instance = m_instance;
-	createInfo.vulkanApiVersion = VK_API_VERSION_1_0;
+	createInfo.vulkanApiVersion = VK_API_VERSION_1_2;
 	createInfo.pVulkanFunctions = &vulkanFunctions;
 	vmaCreateAllocator(&createInfo, &m_allocator);
 }
@@ -88,7 +127,7 @@ void VulkanDevice::pickPhysicalDevice(vk::SurfaceKHR surface)
 		}
 	}
 
-	Logging::Error("failed to find GPU");
+	LOG_ERROR(LogCategory::Vulkan, "failed to find GPU");
 	throw std::runtime_error("failed to find a suitable GPU");
 }
 
@@ -112,11 +151,22 @@ bool VulkanDevice::isDeviceSuitable(vk::PhysicalDevice device, vk::SurfaceKHR su
 	const vk::PhysicalDeviceFeatures support = device.getFeatures();
 
 	bool swapchainSupport = false;
-	if (extensionsSupported(device))
+	if (m_headless)
+	{
+		swapchainSupport = extensionsSupported(device);
+	}
+	else if (extensionsSupported(device))
 	{
 		auto swapchainInfo = vulkan_utils::getSwapchainSupportInfo(device, surface);
 		swapchainSupport = !swapchainInfo.formats.empty() && !swapchainInfo.presentModes.empty();
 	}
 
-	return indices.isValid() && swapchainSupport && support.samplerAnisotropy;
+	bool timelineSupport = false;
+	if (device.getProperties().apiVersion >= VK_API_VERSION_1_2)
+	{
+		auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+		timelineSupport = features.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore;
+	}
+
+	return indices.isValid() && swapchainSupport && timelineSupport && support.samplerAnisotropy;
 }
@@ -8,6 +8,8 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include "Vulkan/Pipeline/PipelineCache.h"
+
 class VulkanInstance;
 
 class VulkanDevice
@@ -20,9 +22,25 @@ public:
 
 	vk::PhysicalDevice getPhysicalDevice() { return m_physicalDevice; }
 	VmaAllocator getAllocator() { return m_allocator; }
+	// shared by every pipeline, loaded from disk on create and written back on destroy
+	vk::PipelineCache getPipelineCache() const { return m_pipelineCache.handle; }
 
 	vk::Queue getGraphicsQueue() const { return m_graphicsQueue; }
 	vk::Queue getPresentQueue() const { return m_presentQueue; }
+	// the graphics queue when the device has no transfer only family
+	vk::Queue getTransferQueue() const { return m_transferQueue; }
+
+	uint32_t getGraphicsQueueFamily() const { return m_graphicsFamily; }
+	uint32_t getTransferQueueFamily() const { return m_transferFamily; }
+	bool hasDedicatedTransferQueue() const { return m_transferFamily != m_graphicsFamily; }
+
+	// true when created without a surface (offscreen rendering only)
+	bool isHeadless() const { return m_headless; }
+
+	// query support, used by the gpu profiler
+	bool supportsPipelineStatistics() const { return m_pipelineStatisticsSupported; }
+	uint32_t getTimestampValidBits() const { return m_timestampValidBits; }
+	float getTimestampPeriod() const { return m_timestampPeriod; }
 
 	vk::Device handle;
 
@@ -38,9 +56,18 @@ private:
 	vk::Instance m_instance;
 	vk::PhysicalDevice m_physicalDevice;
 	VmaAllocator m_allocator;
+	VulkanPipelineCache m_pipelineCache;
 
 	vk::Queue m_graphicsQueue;
 	vk::Queue m_presentQueue;
+	vk::Queue m_transferQueue;
+	uint32_t m_graphicsFamily = 0;
+	uint32_t m_transferFamily = 0;
+	bool m_headless = false;
+
+	bool m_pipelineStatisticsSupported = false;
+	uint32_t m_timestampValidBits = 0;
+	float m_timestampPeriod = 1.f;
 
-	const std::vector<const char*> m_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	std::vector<const char*> m_extensions;
 };
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "FrameTimeline.h"
+
+void FrameTimeline::create(vk::Device device)
+{
+	m_device = device;
+	m_currentFrame = 1;
+
+	vk::SemaphoreTypeCreateInfo typeInfo;
+	typeInfo.setSemaphoreType(vk::SemaphoreType::eTimeline);
+	typeInfo.setInitialValue(0);
+
+	vk::SemaphoreCreateInfo createInfo;
+	createInfo.setPNext(&typeInfo);
+	m_semaphore = m_device.createSemaphore(createInfo);
+}
+
+void FrameTimeline::destroy()
+{
+	m_device.destroySemaphore(m_semaphore);
+}
+
+uint64_t FrameTimeline::getRetiredFrame() const
+{
+	return m_device.getSemaphoreCounterValue(m_semaphore);
+}
+
+bool FrameTimeline::isRetired(uint64_t frame) const
+{
+	return frame == 0 || getRetiredFrame() >= frame;
+}
+
+void FrameTimeline::wait(uint64_t frame) const
+{
+	if (frame == 0)
+		return;
+
+	vk::SemaphoreWaitInfo waitInfo;
+	waitInfo.setSemaphores(m_semaphore);
+	waitInfo.setValues(frame);
+
+	(void) m_device.waitSemaphores(waitInfo, UINT64_MAX);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan.hpp>
+
+// one timeline semaphore counting submitted frames. every frame signals its frame number when it finishes on the gpu,
+// so "has frame N retired" is a counter comparison and nothing else needs to own a fence to find out
+class FrameTimeline
+{
+public:
+	void create(vk::Device device);
+	void destroy();
+
+	// number of the frame being recorded, starts at 1
+	uint64_t getCurrentFrame() const { return m_currentFrame; }
+	// call after the current frame has been submitted
+	void advance() { m_currentFrame++; }
+
+	// highest frame the gpu has finished
+	uint64_t getRetiredFrame() const;
+	bool isRetired(uint64_t frame) const;
+	void wait(uint64_t frame) const;
+
+	// signal this with getCurrentFrame() from the frame's last submission
+	vk::Semaphore getSemaphore() const { return m_semaphore; }
+
+private:
+	vk::Device m_device;
+	vk::Semaphore m_semaphore;
+	uint64_t m_currentFrame = 1;
+};
@@ -14,25 +14,25 @@ VulkanInstance::~VulkanInstance()
 {
 }
 
-void VulkanInstance::create()
+void VulkanInstance::create(bool headless)
 {
-	createInstance();
+	createInstance(headless);
 	if (DebugHelper::validationLayersEnabled())
 	{
 		m_debugHelper.create(handle);
 	}
 }
 
-void VulkanInstance::createInstance()
+void VulkanInstance::createInstance(bool headless)
 {
 	if (!DebugHelper::validationLayersSupported())
 	{
-		Logging::Error("could not load validation layers");
+		LOG_ERROR(LogCategory::Vulkan, "could not load validation layers");
 		throw std::runtime_error("could not load validation layers");
 	}
 
-	const auto extensions = vulkan_utils::getRequiredExtensions(DebugHelper::validationLayersEnabled());
-	const vk::ApplicationInfo appInfo("hello triangle", VK_MAKE_VERSION(1, 0, 0), "no engine", VK_MAKE_VERSION(1, 0, 0), vk::ApiVersion10);
+	const auto extensions = vulkan_utils::getRequiredExtensions(DebugHelper::validationLayersEnabled(), headless);
+	const vk::ApplicationInfo appInfo("hello triangle", VK_MAKE_VERSION(1, 0, 0), "no engine", VK_MAKE_VERSION(1, 0, 0), vk::ApiVersion12);
 
 	vk::InstanceCreateInfo info;
 	info.setPApplicationInfo(&appInfo);
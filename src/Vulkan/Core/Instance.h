@@ -12,13 +12,14 @@ public:
 	VulkanInstance();
 	~VulkanInstance();
 
-	void create();
+	// headless instances skip the glfw surface extensions
+	void create(bool headless = false);
 	void destroy();
 
 	vk::Instance handle;
 
 private:
-	void createInstance();
+	void createInstance(bool headless);
 
 private:
 	DebugHelper m_debugHelper;
@@ -0,0 +1,196 @@
+#include "OffscreenTarget.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "Utils/Logging.hpp"
+
+void VulkanOffscreenTarget::create(VulkanDevice& device, vk::Extent2D extent, vk::Format format, uint32_t imageCount)
+{
+	m_device = device.handle;
+	m_allocator = device.getAllocator();
+	m_format = format;
+	m_extent = extent;
+
+	m_images.resize(imageCount);
+	for (OffscreenImage& image : m_images)
+		createImage(image);
+}
+
+void VulkanOffscreenTarget::createFramebuffers(vk::RenderPass renderPass)
+{
+	for (OffscreenImage& image : m_images)
+	{
+		std::array<vk::ImageView, 1> attachments = { image.view };
+		vk::FramebufferCreateInfo createInfo;
+		createInfo.setRenderPass(renderPass);
+		createInfo.setAttachments(attachments);
+		createInfo.setWidth(m_extent.width);
+		createInfo.setHeight(m_extent.height);
+		createInfo.setLayers(1);
+
+		image.framebuffer = m_device.createFramebuffer(createInfo);
+	}
+}
+
+void VulkanOffscreenTarget::createReadbackBuffers()
+{
+	for (OffscreenImage& image : m_images)
+	{
+		if (!image.readbackBuffer)
+			createReadbackBuffer(image);
+	}
+}
+
+void VulkanOffscreenTarget::destroy()
+{
+	for (OffscreenImage& image : m_images)
+	{
+		m_device.destroyFramebuffer(image.framebuffer);
+		m_device.destroyImageView(image.view);
+		vmaDestroyImage(m_allocator, static_cast<VkImage>(image.handle), image.memory);
+		if (image.readbackBuffer)
+			vmaDestroyBuffer(m_allocator, static_cast<VkBuffer>(image.readbackBuffer), image.readbackMemory);
+	}
+	m_images.clear();
+}
+
+void VulkanOffscreenTarget::createImage(OffscreenImage& image)
+{
+	vk::ImageCreateInfo createInfo;
+	createInfo.setImageType(vk::ImageType::e2D);
+	createInfo.setFormat(m_format);
+	createInfo.setExtent(vk::Extent3D(m_extent.width, m_extent.height, 1));
+	createInfo.setMipLevels(1);
+	createInfo.setArrayLayers(1);
+	createInfo.setSamples(vk::SampleCountFlagBits::e1);
+	createInfo.setTiling(vk::ImageTiling::eOptimal);
+	createInfo.setUsage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc);
+	createInfo.setSharingMode(vk::SharingMode::eExclusive);
+	createInfo.setInitialLayout(vk::ImageLayout::eUndefined);
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	VkResult result = vmaCreateImage(m_allocator, reinterpret_cast<VkImageCreateInfo*>(&createInfo), &allocInfo,
+									 reinterpret_cast<VkImage*>(&image.handle), &image.memory, nullptr);
+
+	if (result != VK_SUCCESS)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "failed to create offscreen image");
+		throw std::runtime_error("failed to create offscreen image");
+	}
+
+	vk::ImageViewCreateInfo viewInfo;
+	viewInfo.setImage(image.handle);
+	viewInfo.setViewType(vk::ImageViewType::e2D);
+	viewInfo.setFormat(m_format);
+	viewInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+	viewInfo.subresourceRange.baseMipLevel = 0;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	image.view = m_device.createImageView(viewInfo);
+}
+
+void VulkanOffscreenTarget::createReadbackBuffer(OffscreenImage& image)
+{
+	vk::BufferCreateInfo createInfo;
+	createInfo.setUsage(vk::BufferUsageFlagBits::eTransferDst);
+	createInfo.setSharingMode(vk::SharingMode::eExclusive);
+	createInfo.setSize(getImageSize());
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VmaAllocationInfo allocationInfo = {};
+	VkResult result = vmaCreateBuffer(m_allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocInfo,
+									  reinterpret_cast<VkBuffer*>(&image.readbackBuffer), &image.readbackMemory, &allocationInfo);
+
+	if (result != VK_SUCCESS)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "failed to create offscreen readback buffer");
+		throw std::runtime_error("failed to create offscreen readback buffer");
+	}
+
+	image.readbackData = allocationInfo.pMappedData;
+}
+
+void VulkanOffscreenTarget::recordReadback(vk::CommandBuffer cmd, uint32_t index) const
+{
+	const OffscreenImage& image = m_images[index];
+
+	vk::ImageSubresourceRange subresourceRange;
+	subresourceRange.setAspectMask(vk::ImageAspectFlagBits::eColor);
+	subresourceRange.setBaseMipLevel(0);
+	subresourceRange.setLevelCount(1);
+	subresourceRange.setBaseArrayLayer(0);
+	subresourceRange.setLayerCount(1);
+
+	// the render pass already left the image in transfer src, this only orders the writes before the copy
+	vk::ImageMemoryBarrier barrier;
+	barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+	barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+	barrier.setSrcQueueFamilyIndex(vk::QueueFamilyIgnored);
+	barrier.setDstQueueFamilyIndex(vk::QueueFamilyIgnored);
+	barrier.setImage(image.handle);
+	barrier.setSubresourceRange(subresourceRange);
+	barrier.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+	barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+
+	cmd.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlagBits(0),
+						0, nullptr, 0, nullptr, 1, &barrier);
+
+	vk::ImageSubresourceLayers subLayers;
+	subLayers.setAspectMask(vk::ImageAspectFlagBits::eColor);
+	subLayers.setMipLevel(0);
+	subLayers.setBaseArrayLayer(0);
+	subLayers.setLayerCount(1);
+
+	vk::BufferImageCopy region;
+	region.setBufferOffset(0);
+	region.setBufferRowLength(0);
+	region.setBufferImageHeight(0);
+	region.setImageOffset(vk::Offset3D(0, 0, 0));
+	region.setImageExtent(vk::Extent3D(m_extent.width, m_extent.height, 1));
+	region.setImageSubresource(subLayers);
+
+	cmd.copyImageToBuffer(image.handle, vk::ImageLayout::eTransferSrcOptimal, image.readbackBuffer, 1, &region);
+
+	vk::BufferMemoryBarrier hostBarrier;
+	hostBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+	hostBarrier.setDstAccessMask(vk::AccessFlagBits::eHostRead);
+	hostBarrier.setSrcQueueFamilyIndex(vk::QueueFamilyIgnored);
+	hostBarrier.setDstQueueFamilyIndex(vk::QueueFamilyIgnored);
+	hostBarrier.setBuffer(image.readbackBuffer);
+	hostBarrier.setOffset(0);
+	hostBarrier.setSize(VK_WHOLE_SIZE);
+
+	cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlagBits(0), 0, nullptr, 1,
+						&hostBarrier, 0, nullptr);
+}
+
+bool VulkanOffscreenTarget::readback(uint32_t index, std::vector<uint8_t>& pixels) const
+{
+	if (index >= m_images.size() || m_images[index].readbackData == nullptr)
+		return false;
+
+	const OffscreenImage& image = m_images[index];
+	const vk::DeviceSize size = getImageSize();
+
+	// GPU_TO_CPU memory is not guaranteed to be coherent
+	vmaInvalidateAllocation(m_allocator, image.readbackMemory, 0, VK_WHOLE_SIZE);
+
+	pixels.resize(size);
+	memcpy(pixels.data(), image.readbackData, size);
+	return true;
+}
+
+vk::DeviceSize VulkanOffscreenTarget::getImageSize() const
+{
+	// offscreen targets are always 8 bit rgba
+	return static_cast<vk::DeviceSize>(m_extent.width) * m_extent.height * 4;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "vk_mem_alloc.h"
+#include "Vulkan/Core/Device.h"
+
+// stands in for the swapchain when rendering without a window, one color image per frame in flight
+class VulkanOffscreenTarget
+{
+public:
+	void create(VulkanDevice& device, vk::Extent2D extent, vk::Format format, uint32_t imageCount);
+	void createFramebuffers(vk::RenderPass renderPass);
+	// host visible buffers the size of every image, only needed once something reads frames back. does nothing if
+	// they exist
+	void createReadbackBuffers();
+	void destroy();
+
+	// copies the rendered image into its host visible readback buffer, must be recorded after the render pass and
+	// only once createReadbackBuffers has run
+	void recordReadback(vk::CommandBuffer cmd, uint32_t index) const;
+	// only valid once the commands recorded by recordReadback have finished executing
+	bool readback(uint32_t index, std::vector<uint8_t>& pixels) const;
+
+	vk::Framebuffer getFramebuffer(uint32_t index) const { return m_images[index].framebuffer; }
+	vk::Image getImage(uint32_t index) const { return m_images[index].handle; }
+	uint32_t getImageCount() const { return static_cast<uint32_t>(m_images.size()); }
+	vk::Format getFormat() const { return m_format; }
+	vk::Extent2D getExtent() const { return m_extent; }
+
+private:
+	struct OffscreenImage
+	{
+		vk::Image handle;
+		VmaAllocation memory = VK_NULL_HANDLE;
+		vk::ImageView view;
+		vk::Framebuffer framebuffer;
+
+		vk::Buffer readbackBuffer;
+		VmaAllocation readbackMemory = VK_NULL_HANDLE;
+		void* readbackData = nullptr;
+	};
+
+	void createImage(OffscreenImage& image);
+	void createReadbackBuffer(OffscreenImage& image);
+
+	vk::DeviceSize getImageSize() const;
+
+private:
+	vk::Device m_device;
+	VmaAllocator m_allocator;
+
+	std::vector<OffscreenImage> m_images;
+	vk::Format m_format;
+	vk::Extent2D m_extent;
+};
@@ -160,6 +160,7 @@ vk::Extent2D VulkanSwapchain::chooseExtent(const vk::SurfaceCapabilitiesKHR& cap
 
 void VulkanSwapchain::VulkanSwapchain::VulkanSwapchain::recreate(GLFWwindow* window)
 {
+	TRACE_ZONE("VulkanSwapchain::recreate");
 	int width = 0, height = 0;
 	glfwGetFramebufferSize(window, &width, &height);
 	while (width == 0 || height == 0)
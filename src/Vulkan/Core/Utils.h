@@ -11,6 +11,7 @@
 #include <GLFW/glfw3.h>
 
 #include "Utils/Logging.hpp"
+#include "Utils/Trace.hpp"
 
 namespace vulkan_utils
 {
@@ -18,8 +19,12 @@ struct QueueFamilyIndices
 {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	// transfer only family (usually a dma engine), copies on it don't compete with rendering
+	std::optional<uint32_t> transferFamily;
+	// headless devices have no surface to present to
+	bool requiresPresent = true;
 
-	bool isValid() const { return graphicsFamily.has_value() && presentFamily.has_value(); }
+	bool isValid() const { return graphicsFamily.has_value() && (presentFamily.has_value() || !requiresPresent); }
 };
 
 struct SwapchainSupportInfo
@@ -33,20 +38,25 @@ inline void printAvailableExtensions()
 {
 	const std::vector<vk::ExtensionProperties> extensions = vk::enumerateInstanceExtensionProperties();
 
-	Logging::Info("--available extensions--");
+	LOG_INFO(LogCategory::Vulkan, "--available extensions--");
 	for (const auto& extension : extensions)
 	{
-		Logging::Info("{}", extension.extensionName.data());
+		LOG_INFO(LogCategory::Vulkan, "{}", extension.extensionName.data());
 	}
 }
 
-inline std::vector<const char*> getRequiredExtensions(bool validationLayersEnabled)
+inline std::vector<const char*> getRequiredExtensions(bool validationLayersEnabled, bool headless = false)
 {
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
+	std::vector<const char*> extensions;
 
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	if (!headless)
+	{
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if (validationLayersEnabled)
 		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -56,13 +66,14 @@ inline std::vector<const char*> getRequiredExtensions(bool validationLayersEnabl
 
 inline std::vector<char> readFile(const std::string& filename)
 {
+	TRACE_ZONE("vulkan_utils::readFile");
 	std::ifstream file(filename, std::ios::ate | std::ios::binary);
 	std::filesystem::path cwd = std::filesystem::current_path();
-	Logging::Info("attempting to open file from directory: {}", cwd.string());
+	LOG_DEBUG(LogCategory::IO, "attempting to open file from directory: {}", cwd.string());
 
 	if (!file.is_open())
 	{
-		Logging::Error("failed to open file: {}", filename);
+		LOG_ERROR(LogCategory::IO, "failed to open file: {}", filename);
 		throw std::runtime_error("failed to open file!");
 	}
 
@@ -89,24 +100,29 @@ inline const std::string getTextureRoot()
 inline QueueFamilyIndices findQueueFamilies(vk::PhysicalDevice device, VkSurfaceKHR surface)
 {
 	QueueFamilyIndices indices;
+	indices.requiresPresent = surface != VK_NULL_HANDLE;
 	auto queueFamilyProperties = device.getQueueFamilyProperties();
 
 	for (int i = 0; i < queueFamilyProperties.size(); i++)
 	{
 		const auto& queueFamily = queueFamilyProperties[i];
 
-		if (device.getSurfaceSupportKHR(i, surface))
+		if (!indices.presentFamily.has_value() && indices.requiresPresent && device.getSurfaceSupportKHR(i, surface))
 		{
 			indices.presentFamily = i;
 		}
 
-		if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
+		if (!indices.graphicsFamily.has_value() && queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
 		{
 			indices.graphicsFamily = i;
 		}
 
-		if (indices.isValid())
-			break;
+		const bool transferOnly = (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) &&
+								  !(queueFamily.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+		if (!indices.transferFamily.has_value() && transferOnly)
+		{
+			indices.transferFamily = i;
+		}
 	}
 
 	return indices;
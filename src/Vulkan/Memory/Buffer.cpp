@@ -1,31 +1,66 @@
 #include "Buffer.h"
 #include "Vulkan/Core/Device.h"
+#include "Utils/Logging.hpp"
+#include <array>
+#include <stdexcept>
 #include <vulkan/vulkan_core.h>
 
-void VulkanBuffer::create(VulkanDevice& vulkanDevice, vk::DeviceSize size, vk::BufferUsageFlags usage)
+void VulkanBuffer::create(VulkanDevice& vulkanDevice, vk::DeviceSize size, vk::BufferUsageFlags usage, VmaMemoryUsage memoryUsage)
 {
 	m_device = vulkanDevice.handle;
 	m_physicalDevice = vulkanDevice.getPhysicalDevice();
 	m_allocator = vulkanDevice.getAllocator();
+	m_size = size;
+
+	const bool deviceLocal = memoryUsage == VMA_MEMORY_USAGE_GPU_ONLY;
+	const std::array<uint32_t, 2> queueFamilies = { vulkanDevice.getGraphicsQueueFamily(), vulkanDevice.getTransferQueueFamily() };
 
 	vk::BufferCreateInfo createInfo;
-	createInfo.setUsage(usage);
-	createInfo.setSharingMode(vk::SharingMode::eExclusive);
+	createInfo.setUsage(deviceLocal ? usage | vk::BufferUsageFlagBits::eTransferDst : usage);
 	createInfo.size = size;
 
+	// device local buffers are written by the transfer queue and read by the graphics queue, concurrent sharing
+	// avoids having to transfer ownership after every upload
+	if (deviceLocal && vulkanDevice.hasDedicatedTransferQueue())
+	{
+		createInfo.setSharingMode(vk::SharingMode::eConcurrent);
+		createInfo.setQueueFamilyIndices(queueFamilies);
+	}
+	else
+	{
+		createInfo.setSharingMode(vk::SharingMode::eExclusive);
+	}
+
+	// host visible buffers stay mapped for their whole lifetime instead of mapping on every copy
 	VmaAllocationCreateInfo allocInfo = {};
-	allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+	allocInfo.usage = memoryUsage;
+	if (!deviceLocal)
+		allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
+	VmaAllocationInfo allocationInfo = {};
 	VkResult result = vmaCreateBuffer(vulkanDevice.getAllocator(), reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocInfo,
-									  reinterpret_cast<VkBuffer*>(&handle), &m_memory, nullptr);
+									  reinterpret_cast<VkBuffer*>(&handle), &m_memory, &allocationInfo);
+
+	if (result != VK_SUCCESS)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "failed to create buffer");
+		throw std::runtime_error("failed to create buffer");
+	}
+
+	m_mapped = allocationInfo.pMappedData;
 }
 
 void VulkanBuffer::copyData(const void* data, vk::DeviceSize size)
 {
-	void* mappedData;
-	vmaMapMemory(m_allocator, m_memory, &mappedData);
-	memcpy(mappedData, data, size);
-	vmaUnmapMemory(m_allocator, m_memory);
+#ifdef DEBUG
+	if (m_mapped == nullptr)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "copyData on a buffer that isn't host visible");
+		return;
+	}
+#endif
+	memcpy(m_mapped, data, size);
+	vmaFlushAllocation(m_allocator, m_memory, 0, size);
 }
 
 void VulkanBuffer::destroy()
@@ -43,12 +78,16 @@ VulkanBuffer::VulkanBuffer(VulkanBuffer&& other)
 	m_physicalDevice = other.m_physicalDevice;
 	m_allocator = other.m_allocator;
 	m_memory = other.m_memory;
+	m_mapped = other.m_mapped;
+	m_size = other.m_size;
 
 	other.handle = VK_NULL_HANDLE;
 	other.m_device = VK_NULL_HANDLE;
 	other.m_physicalDevice = VK_NULL_HANDLE;
 	other.m_allocator = VK_NULL_HANDLE;
 	other.m_memory = VK_NULL_HANDLE;
+	other.m_mapped = nullptr;
+	other.m_size = 0;
 }
 
 VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& rhs)
@@ -63,12 +102,16 @@ VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& rhs)
 	m_physicalDevice = rhs.m_physicalDevice;
 	m_allocator = rhs.m_allocator;
 	m_memory = rhs.m_memory;
+	m_mapped = rhs.m_mapped;
+	m_size = rhs.m_size;
 
 	rhs.handle = VK_NULL_HANDLE;
 	rhs.m_device = VK_NULL_HANDLE;
 	rhs.m_physicalDevice = VK_NULL_HANDLE;
 	rhs.m_allocator = VK_NULL_HANDLE;
 	rhs.m_memory = VK_NULL_HANDLE;
+	rhs.m_mapped = nullptr;
+	rhs.m_size = 0;
 
 	return *this;
 }
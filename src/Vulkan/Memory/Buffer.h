@@ -17,10 +17,14 @@ public:
 	VulkanBuffer(VulkanBuffer&& other);
 	VulkanBuffer& operator=(VulkanBuffer&& rhs);
 
-	void create(VulkanDevice& vulkanDevice, vk::DeviceSize size, vk::BufferUsageFlags usage);
+	// GPU_ONLY buffers can't be mapped and have to be filled through VulkanUploadManager
+	void create(VulkanDevice& vulkanDevice, vk::DeviceSize size, vk::BufferUsageFlags usage,
+				VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU);
 	void copyData(const void* data, vk::DeviceSize size);
 	void destroy();
 
+	vk::DeviceSize getSize() const { return m_size; }
+
 	vk::Buffer handle;
 
 protected:
@@ -28,4 +32,6 @@ protected:
 	vk::PhysicalDevice m_physicalDevice;
 	VmaAllocator m_allocator;
 	VmaAllocation m_memory;
+	void* m_mapped = nullptr;
+	vk::DeviceSize m_size = 0;
 };
\ No newline at end of file
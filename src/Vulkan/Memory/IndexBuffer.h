@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "UploadManager.h"
 
 #include "Utils/Logging.hpp"
 
@@ -11,10 +12,22 @@ public:
 	{
 #ifdef DEBUG
 		if (indices.size() >= 65534)
-			Logging::Warning("16 bit index buffer limit reached");
+			LOG_WARNING(LogCategory::Vulkan, "16 bit index buffer limit reached");
 #endif
 		vk::DeviceSize size = sizeof(indices[0]) * indices.size();
 		VulkanBuffer::create(device, size, vk::BufferUsageFlagBits::eIndexBuffer);
 		copyData(indices.data(), size);
 	}
+
+	// static geometry, placed in device local memory and filled by the upload manager
+	uint64_t create(VulkanDevice& device, const std::vector<uint16_t>& indices, VulkanUploadManager& uploads)
+	{
+#ifdef DEBUG
+		if (indices.size() >= 65534)
+			LOG_WARNING(LogCategory::Vulkan, "16 bit index buffer limit reached");
+#endif
+		vk::DeviceSize size = sizeof(indices[0]) * indices.size();
+		VulkanBuffer::create(device, size, vk::BufferUsageFlagBits::eIndexBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+		return uploads.uploadBuffer(*this, indices.data(), size);
+	}
 };
\ No newline at end of file
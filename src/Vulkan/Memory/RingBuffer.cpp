@@ -0,0 +1,92 @@
+#include "RingBuffer.h"
+
+#include <stdexcept>
+
+#include "Utils/Logging.hpp"
+
+namespace
+{
+vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+{
+	return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+} // namespace
+
+void VulkanRingBuffer::create(VulkanDevice& device, vk::DeviceSize capacity, uint32_t framesInFlight, vk::BufferUsageFlags usage)
+{
+	m_allocator = device.getAllocator();
+	m_capacity = capacity;
+	m_frameUsed.assign(framesInFlight, 0);
+	m_uniformAlignment = device.getPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+
+	vk::BufferCreateInfo createInfo;
+	createInfo.setUsage(usage);
+	createInfo.setSharingMode(vk::SharingMode::eExclusive);
+	createInfo.setSize(capacity);
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VmaAllocationInfo allocationInfo = {};
+	VkResult result = vmaCreateBuffer(m_allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocInfo,
+									  reinterpret_cast<VkBuffer*>(&handle), &m_memory, &allocationInfo);
+
+	if (result != VK_SUCCESS)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "failed to create ring buffer");
+		throw std::runtime_error("failed to create ring buffer");
+	}
+
+	m_mapped = static_cast<uint8_t*>(allocationInfo.pMappedData);
+}
+
+void VulkanRingBuffer::destroy()
+{
+	if (handle != VK_NULL_HANDLE)
+		vmaDestroyBuffer(m_allocator, static_cast<VkBuffer>(handle), m_memory);
+
+	handle = VK_NULL_HANDLE;
+	m_mapped = nullptr;
+}
+
+void VulkanRingBuffer::beginFrame(uint32_t frameIndex)
+{
+	m_used -= m_frameUsed[frameIndex];
+	m_frameUsed[frameIndex] = 0;
+	m_currentFrame = frameIndex;
+}
+
+void VulkanRingBuffer::flush()
+{
+	// no-op on host coherent memory
+	vmaFlushAllocation(m_allocator, m_memory, 0, VK_WHOLE_SIZE);
+}
+
+std::optional<RingAllocation> VulkanRingBuffer::allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	vk::DeviceSize offset = alignUp(m_head, alignment);
+	vk::DeviceSize required = offset - m_head + size;
+
+	// doesn't fit before the end, skip the tail and start over at the front
+	if (offset + size > m_capacity)
+	{
+		offset = 0;
+		required = m_capacity - m_head + size;
+	}
+
+	// the free region starts at the head and is contiguous (modulo wrapping) since frames retire in order
+	if (size > m_capacity || required > m_capacity - m_used)
+		return std::nullopt;
+
+	m_head = offset + size;
+	m_used += required;
+	m_frameUsed[m_currentFrame] += required;
+
+	RingAllocation allocation;
+	allocation.buffer = handle;
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.data = m_mapped + offset;
+	return allocation;
+}
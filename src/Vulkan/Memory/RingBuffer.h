@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "vk_mem_alloc.h"
+#include "Vulkan/Core/Device.h"
+
+struct RingAllocation
+{
+	vk::Buffer buffer;
+	// also the dynamic offset when bound through a dynamic descriptor
+	vk::DeviceSize offset = 0;
+	vk::DeviceSize size = 0;
+	void* data = nullptr;
+};
+
+// one persistently mapped buffer shared by every frame in flight. allocations are a pointer bump, and the space a
+// frame used is handed back once that frame's fence has signaled. frames retire in submission order so the live
+// region is always contiguous, starting at the oldest unretired frame
+class VulkanRingBuffer
+{
+public:
+	VulkanRingBuffer() = default;
+	VulkanRingBuffer(const VulkanRingBuffer&) = delete;
+	VulkanRingBuffer& operator=(const VulkanRingBuffer&) = delete;
+
+	void create(VulkanDevice& device, vk::DeviceSize capacity, uint32_t framesInFlight, vk::BufferUsageFlags usage);
+	void destroy();
+
+	// call once the fence of frameIndex has signaled, reclaims everything allocated the last time this frame was recorded
+	void beginFrame(uint32_t frameIndex);
+	// makes the frame's writes visible to the gpu, call before submitting
+	void flush();
+
+	// returns nullopt when the ring is full, memory stays valid until the current frame retires
+	std::optional<RingAllocation> allocate(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+
+	template<class T>
+	std::optional<RingAllocation> upload(const T* data, size_t count, vk::DeviceSize alignment = alignof(T));
+
+	// alignment uniform buffer sub-allocations need to be used as dynamic offsets
+	vk::DeviceSize getUniformAlignment() const { return m_uniformAlignment; }
+	vk::DeviceSize getCapacity() const { return m_capacity; }
+	vk::DeviceSize getUsed() const { return m_used; }
+
+	vk::Buffer handle;
+
+private:
+	VmaAllocator m_allocator;
+	VmaAllocation m_memory = VK_NULL_HANDLE;
+	uint8_t* m_mapped = nullptr;
+
+	vk::DeviceSize m_capacity = 0;
+	vk::DeviceSize m_head = 0;
+	vk::DeviceSize m_used = 0;
+	vk::DeviceSize m_uniformAlignment = 256;
+
+	// bytes (including padding) each frame in flight consumed, handed back in beginFrame
+	std::vector<vk::DeviceSize> m_frameUsed;
+	uint32_t m_currentFrame = 0;
+};
+
+template<class T>
+std::optional<RingAllocation> VulkanRingBuffer::upload(const T* data, size_t count, vk::DeviceSize alignment)
+{
+	std::optional<RingAllocation> allocation = allocate(sizeof(T) * count, alignment);
+	if (allocation.has_value() && count > 0)
+		memcpy(allocation->data, data, sizeof(T) * count);
+	return allocation;
+}
@@ -0,0 +1,203 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "Utils/Logging.hpp"
+
+void VulkanUploadManager::create(VulkanDevice& device, vk::DeviceSize stagingSize)
+{
+	m_device = device.handle;
+	m_allocator = device.getAllocator();
+	m_queue = device.getTransferQueue();
+	m_stagingSize = stagingSize;
+
+	vk::CommandPoolCreateInfo poolInfo;
+	poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+	poolInfo.setQueueFamilyIndex(device.getTransferQueueFamily());
+	m_commandPool = m_device.createCommandPool(poolInfo);
+
+	vk::SemaphoreTypeCreateInfo typeInfo;
+	typeInfo.setSemaphoreType(vk::SemaphoreType::eTimeline);
+	typeInfo.setInitialValue(0);
+
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.setPNext(&typeInfo);
+	m_timeline = m_device.createSemaphore(semaphoreInfo);
+
+	if (device.hasDedicatedTransferQueue())
+		LOG_INFO(LogCategory::Vulkan, "using dedicated transfer queue family {}", device.getTransferQueueFamily());
+}
+
+void VulkanUploadManager::destroy()
+{
+	std::scoped_lock lock(m_mutex);
+
+	wait(m_submittedValue);
+
+	for (Batch& batch : m_batches)
+		destroyStaging(batch);
+	m_batches.clear();
+	m_open = -1;
+
+	m_device.destroySemaphore(m_timeline);
+	m_device.destroyCommandPool(m_commandPool);
+}
+
+uint64_t VulkanUploadManager::uploadBuffer(VulkanBuffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset)
+{
+	std::scoped_lock lock(m_mutex);
+
+	Batch& batch = acquireBatch(size);
+	memcpy(batch.mapped + batch.used, data, size);
+
+	vk::BufferCopy region;
+	region.setSrcOffset(batch.used);
+	region.setDstOffset(dstOffset);
+	region.setSize(size);
+	batch.cmd.copyBuffer(batch.staging, dst.handle, 1, &region);
+
+	// keep every copy source 16 byte aligned
+	batch.used = std::min(batch.capacity, (batch.used + size + 15) & ~vk::DeviceSize(15));
+
+	return m_nextValue;
+}
+
+void VulkanUploadManager::submit()
+{
+	std::scoped_lock lock(m_mutex);
+	submitLocked();
+}
+
+void VulkanUploadManager::submitLocked()
+{
+	if (m_open < 0)
+		return;
+
+	Batch& batch = m_batches[m_open];
+	m_open = -1;
+
+	batch.cmd.end();
+	vmaFlushAllocation(m_allocator, batch.stagingMemory, 0, batch.used);
+
+	batch.value = m_nextValue++;
+
+	vk::TimelineSemaphoreSubmitInfo timelineInfo;
+	timelineInfo.setSignalSemaphoreValues(batch.value);
+
+	vk::SubmitInfo submitInfo;
+	submitInfo.setPNext(&timelineInfo);
+	submitInfo.setCommandBuffers(batch.cmd);
+	submitInfo.setSignalSemaphores(m_timeline);
+
+	(void) m_queue.submit(1, &submitInfo, nullptr);
+	m_submittedValue = batch.value;
+}
+
+bool VulkanUploadManager::isComplete(uint64_t value) const
+{
+	return m_device.getSemaphoreCounterValue(m_timeline) >= value;
+}
+
+void VulkanUploadManager::wait(uint64_t value) const
+{
+	vk::SemaphoreWaitInfo waitInfo;
+	waitInfo.setSemaphores(m_timeline);
+	waitInfo.setValues(value);
+
+	(void) m_device.waitSemaphores(waitInfo, UINT64_MAX);
+}
+
+VulkanUploadManager::Batch& VulkanUploadManager::acquireBatch(vk::DeviceSize size)
+{
+	if (m_open >= 0)
+	{
+		Batch& open = m_batches[m_open];
+		if (open.capacity - open.used >= size)
+			return open;
+
+		// out of staging space, send what we have and continue in a fresh batch
+		submitLocked();
+	}
+
+	const uint64_t completed = m_device.getSemaphoreCounterValue(m_timeline);
+
+	int32_t index = -1;
+	for (int32_t i = 0; i < static_cast<int32_t>(m_batches.size()); i++)
+	{
+		if (m_batches[i].value <= completed)
+		{
+			index = i;
+			break;
+		}
+	}
+
+	if (index < 0)
+	{
+		vk::CommandBufferAllocateInfo allocInfo;
+		allocInfo.setCommandPool(m_commandPool);
+		allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+		allocInfo.setCommandBufferCount(1);
+
+		Batch batch;
+		batch.cmd = m_device.allocateCommandBuffers(allocInfo).front();
+		m_batches.push_back(batch);
+		index = static_cast<int32_t>(m_batches.size()) - 1;
+	}
+
+	Batch& batch = m_batches[index];
+	if (batch.capacity < size)
+	{
+		destroyStaging(batch);
+		createStaging(batch, std::max(size, m_stagingSize));
+	}
+
+	batch.used = 0;
+	batch.value = 0;
+	batch.cmd.reset();
+
+	vk::CommandBufferBeginInfo beginInfo;
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+	batch.cmd.begin(beginInfo);
+
+	m_open = index;
+	return batch;
+}
+
+void VulkanUploadManager::createStaging(Batch& batch, vk::DeviceSize size)
+{
+	vk::BufferCreateInfo createInfo;
+	createInfo.setUsage(vk::BufferUsageFlagBits::eTransferSrc);
+	createInfo.setSharingMode(vk::SharingMode::eExclusive);
+	createInfo.setSize(size);
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VmaAllocationInfo allocationInfo = {};
+	VkResult result = vmaCreateBuffer(m_allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocInfo,
+									  reinterpret_cast<VkBuffer*>(&batch.staging), &batch.stagingMemory, &allocationInfo);
+
+	if (result != VK_SUCCESS)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "failed to create staging buffer");
+		throw std::runtime_error("failed to create staging buffer");
+	}
+
+	batch.mapped = static_cast<uint8_t*>(allocationInfo.pMappedData);
+	batch.capacity = size;
+}
+
+void VulkanUploadManager::destroyStaging(Batch& batch)
+{
+	if (batch.staging)
+		vmaDestroyBuffer(m_allocator, static_cast<VkBuffer>(batch.staging), batch.stagingMemory);
+
+	batch.staging = nullptr;
+	batch.stagingMemory = VK_NULL_HANDLE;
+	batch.mapped = nullptr;
+	batch.capacity = 0;
+}
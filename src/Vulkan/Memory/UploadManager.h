@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "vk_mem_alloc.h"
+#include "Vulkan/Core/Device.h"
+#include "Vulkan/Memory/Buffer.h"
+
+// fills device local buffers through host visible staging memory. copies are batched into one command buffer and
+// submitted together on the transfer queue, completion is tracked with a timeline semaphore so nothing ever waits
+// for the queue to go idle
+class VulkanUploadManager
+{
+public:
+	VulkanUploadManager() = default;
+	VulkanUploadManager(const VulkanUploadManager&) = delete;
+	VulkanUploadManager& operator=(const VulkanUploadManager&) = delete;
+
+	void create(VulkanDevice& device, vk::DeviceSize stagingSize = 16 * 1024 * 1024);
+	void destroy();
+
+	// copies data into staging memory and queues the copy, the destination must not be in use by the gpu.
+	// safe to call from any thread, returns the value the timeline reaches once the copy has finished
+	uint64_t uploadBuffer(VulkanBuffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0);
+
+	// submits everything queued since the last submit, must be called from the thread that owns the graphics queue
+	// because the transfer queue falls back to it on devices without a transfer only family
+	void submit();
+
+	// true once the copies up to value have finished executing
+	bool isComplete(uint64_t value) const;
+	void wait(uint64_t value) const;
+
+	// graphics submissions that read uploaded data wait on this semaphore for getSubmittedValue()
+	vk::Semaphore getSemaphore() const { return m_timeline; }
+	uint64_t getSubmittedValue() const { return m_submittedValue; }
+
+private:
+	struct Batch
+	{
+		vk::CommandBuffer cmd;
+		vk::Buffer staging;
+		VmaAllocation stagingMemory = VK_NULL_HANDLE;
+		uint8_t* mapped = nullptr;
+		vk::DeviceSize capacity = 0;
+		vk::DeviceSize used = 0;
+		// timeline value signaled when the batch finishes, 0 while it is being filled
+		uint64_t value = 0;
+	};
+
+	void submitLocked();
+	Batch& acquireBatch(vk::DeviceSize size);
+	void createStaging(Batch& batch, vk::DeviceSize size);
+	void destroyStaging(Batch& batch);
+
+private:
+	vk::Device m_device;
+	VmaAllocator m_allocator;
+	vk::Queue m_queue;
+	vk::CommandPool m_commandPool;
+	vk::Semaphore m_timeline;
+	vk::DeviceSize m_stagingSize = 0;
+
+	std::mutex m_mutex;
+	std::vector<Batch> m_batches;
+	// index into m_batches of the batch being filled
+	int32_t m_open = -1;
+	// value the next submitted batch will signal
+	uint64_t m_nextValue = 1;
+	uint64_t m_submittedValue = 0;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "UploadManager.h"
 #include "Vulkan/Core/Device.h"
 #include "Renderer/Types/Vertex.h"
 
@@ -16,4 +17,12 @@ public:
 		VulkanBuffer::create(device, size, vk::BufferUsageFlagBits::eVertexBuffer);
 		copyData(vertices.data(), size);
 	}
+
+	// static geometry, placed in device local memory and filled by the upload manager
+	uint64_t create(VulkanDevice& device, const std::vector<Vertex>& vertices, VulkanUploadManager& uploads)
+	{
+		vk::DeviceSize size = sizeof(vertices[0]) * vertices.size();
+		VulkanBuffer::create(device, size, vk::BufferUsageFlagBits::eVertexBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+		return uploads.uploadBuffer(*this, vertices.data(), size);
+	}
 };
\ No newline at end of file
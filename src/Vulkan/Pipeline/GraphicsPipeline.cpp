@@ -2,18 +2,32 @@
 #include <cmath>
 #include <vulkan/vulkan.hpp>
 
+#include "Vulkan/Core/Device.h"
 #include "Vulkan/Core/Utils.h"
 #include "Renderer/Types/Vertex.h"
 
-void VulkanGraphicsPipeline::create(vk::Device device,
+void VulkanGraphicsPipeline::create(VulkanDevice& device,
 									VulkanSwapchain& swapchain,
 									const std::string& vertexSPV,
 									const std::string& fragSPV,
 									vk::DescriptorSetLayout layout)
 {
-	m_device = device;
-	createRenderPass(swapchain.getFormat());
-	createPipeline(vertexSPV, fragSPV, swapchain.getExtent(), layout);
+	create(device, swapchain.getFormat(), swapchain.getExtent(), vk::ImageLayout::ePresentSrcKHR, vertexSPV, fragSPV, layout);
+}
+
+void VulkanGraphicsPipeline::create(VulkanDevice& device,
+									vk::Format format,
+									vk::Extent2D extent,
+									vk::ImageLayout finalLayout,
+									const std::string& vertexSPV,
+									const std::string& fragSPV,
+									vk::DescriptorSetLayout layout)
+{
+	TRACE_ZONE("VulkanGraphicsPipeline::create");
+	m_device = device.handle;
+	m_pipelineCache = device.getPipelineCache();
+	createRenderPass(format, finalLayout);
+	createPipeline(vertexSPV, fragSPV, extent, layout);
 }
 
 void VulkanGraphicsPipeline::VulkanGraphicsPipeline::destroy()
@@ -41,17 +55,17 @@ vk::PipelineShaderStageCreateInfo VulkanGraphicsPipeline::createShaderStage(cons
 	return createInfo;
 }
 
-void VulkanGraphicsPipeline::VulkanGraphicsPipeline::createRenderPass(vk::Format swapchainFormat)
+void VulkanGraphicsPipeline::VulkanGraphicsPipeline::createRenderPass(vk::Format format, vk::ImageLayout finalLayout)
 {
 	vk::AttachmentDescription colorAttachment;
-	colorAttachment.setFormat(swapchainFormat);
+	colorAttachment.setFormat(format);
 	colorAttachment.setSamples(vk::SampleCountFlagBits::e1);
 	colorAttachment.setLoadOp(vk::AttachmentLoadOp::eClear);
 	colorAttachment.setStoreOp(vk::AttachmentStoreOp::eStore);
 	colorAttachment.setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
 	colorAttachment.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
 	colorAttachment.setInitialLayout(vk::ImageLayout::eUndefined);
-	colorAttachment.setFinalLayout(vk::ImageLayout::ePresentSrcKHR);
+	colorAttachment.setFinalLayout(finalLayout);
 
 	vk::AttachmentReference colorAttachmentReference;
 	colorAttachmentReference.setAttachment(0);
@@ -92,12 +106,16 @@ void VulkanGraphicsPipeline::VulkanGraphicsPipeline::createPipeline(const std::s
 		createShaderStage(shaderRoot + fragSPV, vk::ShaderStageFlagBits::eFragment)
 	};
 
-	auto bindingDescription = Vertex::getBindingDescription();
-	auto attributeDescription = Vertex::getAttributeDescription();
+	if (!m_vertexInput.has_value())
+	{
+		auto attributeDescription = Vertex::getAttributeDescription();
+		m_vertexInput = VertexInputDescription { { Vertex::getBindingDescription() },
+												 { attributeDescription.begin(), attributeDescription.end() } };
+	}
+
 	vk::PipelineVertexInputStateCreateInfo vertexInputState;
-	vertexInputState.setVertexBindingDescriptionCount(1);
-	vertexInputState.setPVertexBindingDescriptions(&bindingDescription);
-	vertexInputState.setVertexAttributeDescriptions(attributeDescription);
+	vertexInputState.setVertexBindingDescriptions(m_vertexInput->bindings);
+	vertexInputState.setVertexAttributeDescriptions(m_vertexInput->attributes);
 
 	vk::PipelineInputAssemblyStateCreateInfo inputAssembly;
 	inputAssembly.setTopology(vk::PrimitiveTopology::eTriangleList);
@@ -192,11 +210,11 @@ void VulkanGraphicsPipeline::VulkanGraphicsPipeline::createPipeline(const std::s
 	createInfo.setRenderPass(m_renderPass);
 	createInfo.setSubpass(0);
 
-	auto pipelines = m_device.createGraphicsPipelines(nullptr, createInfo);
+	auto pipelines = m_device.createGraphicsPipelines(m_pipelineCache, createInfo);
 	handle = pipelines.value[0];
 
 	if (pipelines.result != vk::Result::eSuccess)
-		Logging::Error("failed to create pipeline");
+		LOG_ERROR(LogCategory::Vulkan, "failed to create pipeline");
 
 	for (vk::ShaderModule shader : m_cachedShaderModules)
 		m_device.destroyShaderModule(shader);
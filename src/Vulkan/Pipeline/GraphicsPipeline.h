@@ -2,20 +2,38 @@
 
 #include "Vulkan/Core/Swapchain.h"
 #include <vulkan/vulkan.hpp>
+#include <optional>
 #include <vector>
 
 class VulkanDevice;
 
+struct VertexInputDescription
+{
+	std::vector<vk::VertexInputBindingDescription> bindings;
+	std::vector<vk::VertexInputAttributeDescription> attributes;
+};
+
 class VulkanGraphicsPipeline
 {
 public:
-	void create(vk::Device device,
+	void create(VulkanDevice& device,
 				VulkanSwapchain& swapchain,
 				const std::string& vertexSPV,
 				const std::string& fragSPV,
 				vk::DescriptorSetLayout layout);
+	// render into an arbitrary color target, finalLayout is the layout the attachment is left in
+	void create(VulkanDevice& device,
+				vk::Format format,
+				vk::Extent2D extent,
+				vk::ImageLayout finalLayout,
+				const std::string& vertexSPV,
+				const std::string& fragSPV,
+				vk::DescriptorSetLayout layout);
 	void destroy();
 
+	// must be called before create, defaults to a single Vertex binding
+	void setVertexInput(VertexInputDescription vertexInput) { m_vertexInput = std::move(vertexInput); }
+
 	vk::RenderPass getRenderPass() const { return m_renderPass; }
 	vk::PipelineLayout getLayout() const { return m_layout; }
 
@@ -23,7 +41,7 @@ public:
 
 private:
 	vk::PipelineShaderStageCreateInfo createShaderStage(const std::string& shaderSPV, vk::ShaderStageFlagBits stage);
-	void createRenderPass(vk::Format swapchainFormat);
+	void createRenderPass(vk::Format format, vk::ImageLayout finalLayout);
 	void createPipeline(const std::string& vertexSPV,
 						const std::string& fragSPV,
 						vk::Extent2D swapchainExtent,
@@ -31,8 +49,10 @@ private:
 
 private:
 	vk::Device m_device;
+	vk::PipelineCache m_pipelineCache;
 
 	vk::PipelineLayout m_layout;
 	vk::RenderPass m_renderPass;
 	std::vector<vk::ShaderModule> m_cachedShaderModules;
+	std::optional<VertexInputDescription> m_vertexInput;
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "PipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "Utils/Logging.hpp"
+
+namespace
+{
+// layout of VkPipelineCacheHeaderVersionOne
+constexpr size_t headerSize = 16 + VK_UUID_SIZE;
+
+uint32_t readUint32(const std::vector<char>& data, size_t offset)
+{
+	uint32_t value = 0;
+	memcpy(&value, data.data() + offset, sizeof(value));
+	return value;
+}
+
+std::vector<char> readCacheFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+		return {};
+
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+	if (!file)
+		return {};
+	return data;
+}
+} // namespace
+
+void VulkanPipelineCache::create(vk::Device device, vk::PhysicalDevice physicalDevice, const std::string& path)
+{
+	m_device = device;
+	m_properties = physicalDevice.getProperties();
+	m_path = path;
+
+	std::vector<char> data = readCacheFile(m_path);
+	if (!data.empty() && !isCompatible(data))
+	{
+		LOG_INFO(LogCategory::Vulkan, "pipeline cache {} was written by another device or driver, ignoring it", m_path);
+		data.clear();
+	}
+
+	vk::PipelineCacheCreateInfo createInfo;
+	createInfo.setInitialDataSize(data.size());
+	createInfo.setPInitialData(data.data());
+
+	handle = m_device.createPipelineCache(createInfo);
+
+	if (!data.empty())
+		LOG_INFO(LogCategory::Vulkan, "loaded pipeline cache {} ({} bytes)", m_path, data.size());
+}
+
+bool VulkanPipelineCache::save() const
+{
+	if (!handle)
+		return false;
+
+	const std::vector<uint8_t> data = m_device.getPipelineCacheData(handle);
+	const std::string tempPath = m_path + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		file.close();
+
+		if (!file)
+		{
+			LOG_ERROR(LogCategory::Vulkan, "failed to write pipeline cache {}", tempPath);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, m_path, error);
+	if (error)
+	{
+		LOG_ERROR(LogCategory::Vulkan, "failed to replace pipeline cache {}: {}", m_path, error.message());
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+void VulkanPipelineCache::destroy()
+{
+	m_device.destroyPipelineCache(handle);
+	handle = nullptr;
+}
+
+bool VulkanPipelineCache::isCompatible(const std::vector<char>& data) const
+{
+	if (data.size() < headerSize)
+		return false;
+
+	const uint32_t length = readUint32(data, 0);
+	const uint32_t version = readUint32(data, 4);
+	const uint32_t vendorID = readUint32(data, 8);
+	const uint32_t deviceID = readUint32(data, 12);
+
+	return length >= headerSize && length <= data.size() && version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		   vendorID == m_properties.vendorID && deviceID == m_properties.deviceID &&
+		   memcmp(data.data() + 16, m_properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+// VkPipelineCache backed by a file, so pipelines compiled on one run are reused by the next. a blob written by a
+// different gpu or driver is rejected and the cache starts empty
+class VulkanPipelineCache
+{
+public:
+	void create(vk::Device device, vk::PhysicalDevice physicalDevice, const std::string& path);
+	// writes the cache to a temporary file and renames it over the old one, so a crash never leaves a torn file
+	bool save() const;
+	void destroy();
+
+	vk::PipelineCache handle;
+
+private:
+	bool isCompatible(const std::vector<char>& data) const;
+
+private:
+	vk::Device m_device;
+	vk::PhysicalDeviceProperties m_properties;
+	std::string m_path;
+};
@@ -116,10 +116,10 @@ void PipelineDescriptor::addResource(vk::DescriptorType type, uint32_t count, vk
 
 void PipelineDescriptor::printDebugInfo() const
 {
-	Logging::Info("\t\t--displaying layout info--");
-	Logging::Info("\t\t\tframes in flight: {}", Renderer::getFramesInFlight());
-	Logging::Info("\ttype\tcount\tstage");
-	Logging::Info("---------------------------------------------");
+	LOG_INFO(LogCategory::Vulkan, "\t\t--displaying layout info--");
+	LOG_INFO(LogCategory::Vulkan, "\t\t\tframes in flight: {}", Renderer::getFramesInFlight());
+	LOG_INFO(LogCategory::Vulkan, "\ttype\tcount\tstage");
+	LOG_INFO(LogCategory::Vulkan, "---------------------------------------------");
 	for (auto& tuple : m_debugInfo)
 	{
 		vk::DescriptorType type;
@@ -127,6 +127,6 @@ void PipelineDescriptor::printDebugInfo() const
 		vk::ShaderStageFlags stage;
 		std::tie(type, count, stage) = tuple;
 		// fix this
-		//  Logging::Info("\t{}\t{}\t{}", type, count, stage);
+		//  LOG_INFO(LogCategory::Vulkan, "\t{}\t{}\t{}", type, count, stage);
 	}
 }
@@ -1,4 +1,9 @@
+#include <cctype>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <string_view>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -8,25 +13,210 @@
 
 #include "Vulkan/Core/Window.h"
 #include "Renderer/Renderer.h"
+#include "Sim/Simulation.h"
 
+#include "Utils/JobSystem.hpp"
 #include "Utils/Logging.hpp"
 #include "Utils/Time.hpp"
+#include "Utils/Trace.hpp"
 
+namespace
+{
+bool hasArgument(int argc, char** argv, std::string_view argument)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (argument == argv[i])
+			return true;
+	}
+	return false;
+}
+
+// value following argument, e.g. "--frames-in-flight 3"
+std::optional<std::string_view> getArgumentValue(int argc, char** argv, std::string_view argument)
+{
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (argument == argv[i])
+			return argv[i + 1];
+	}
+	return std::nullopt;
+}
 
-int main()
+// value of a count argument, warns and gives nothing if it isn't a whole number that fits in 32 bits
+std::optional<uint32_t> parseCount(std::string_view argument, std::string_view value)
 {
+	uint32_t count = 0;
+	const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+	if (error == std::errc::result_out_of_range)
+		Logging::Warning("{} {} is too large", argument, value);
+	else if (error != std::errc() || end != value.data() + value.size())
+		Logging::Warning("{} expects a number, got {}", argument, value);
+	else
+		return count;
+	return std::nullopt;
+}
+
+void exportProfile(Renderer& renderer)
+{
+	GpuProfiler& profiler = renderer.getProfiler();
+	const FrameProfile average = profiler.getAverage();
+	Logging::Info("profile: cpu {:.3f}ms (fence wait {:.3f}ms, acquire {:.3f}ms, record {:.3f}ms), gpu {:.3f}ms",
+				  average.getCpuTotalMs(), average.cpuMs[static_cast<size_t>(CpuStage::FenceWait)],
+				  average.cpuMs[static_cast<size_t>(CpuStage::Acquire)], average.cpuMs[static_cast<size_t>(CpuStage::Record)],
+				  average.gpuFrameMs);
+
+	profiler.exportCsv("gpu_profile.csv");
+	profiler.exportJson("gpu_profile.json");
+	renderer.getFrameStats().exportCsv("frame_stats.csv");
+}
+
+void exportTrace()
+{
+	if (Trace::ExportChromeJson("trace.json"))
+		Logging::Info("wrote cpu trace to trace.json");
+	else
+		Logging::Error("failed to write trace.json");
+}
+
+// runs the ticks the sim clock has accumulated, or exactly one when headless so benchmarks don't depend on timing
+void updateSimulation(Simulation& simulation, Renderer& renderer, bool headless)
+{
+	const auto start = std::chrono::steady_clock::now();
+	if (headless)
+		simulation.tick();
+	else
+	{
+		while (Time::ConsumeTick())
+			simulation.tick();
+	}
+	renderer.getFrameStats().record(FrameStat::SimTick,
+									std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+	simulation.syncSprites(renderer.getSpriteBatch());
+}
+
+// renders frameCount frames offscreen and reports the average cpu frame time, used for benchmarking on machines without a display
+int runHeadless(uint32_t frameCount, Simulation& simulation, bool profile, bool trace)
+{
+	Renderer renderer;
+	renderer.initHeadless({ 800, 600 });
 
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		updateSimulation(simulation, renderer, true);
+		renderer.drawFrame();
+	}
+	renderer.waitIdle();
+	const auto end = std::chrono::steady_clock::now();
+
+	const double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+	Logging::Info("headless: {} frames in {:.2f}ms ({:.3f}ms/frame)", frameCount, totalMs, totalMs / frameCount);
+
+	renderer.getFrameStats().logSummary();
+	if (profile)
+		exportProfile(renderer);
+	if (trace)
+		exportTrace();
+
+	renderer.cleanup();
+	return 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
 	Logging::Init();
+
+	// --log [level][,category=level...], e.g. --log info,render=debug
+	const std::optional<std::string_view> logLevels = getArgumentValue(argc, argv, "--log");
+	if (logLevels.has_value() && !Logging::ParseLevels(logLevels.value()))
+		Logging::Warning("invalid --log levels: {}", logLevels.value());
+
+	// --log-binary defers formatting of plain arguments to the console thread, so verbose levels cost the logging
+	// threads little more than a copy
+	if (hasArgument(argc, argv, "--log-binary"))
+		Logging::SetBinaryMode(true);
+
+	// --log-file [path], also writes the log to a size rotated file
+	const std::optional<std::string_view> logFile = getArgumentValue(argc, argv, "--log-file");
+	if (logFile.has_value())
+	{
+		if (auto console = Console::Get().lock())
+			console->AddSink(std::make_shared<RotatingFileSink>(std::filesystem::path(logFile.value())));
+	}
+
+	// --profile writes gpu_profile.csv/json and frame_stats.csv on exit
+	const bool profile = hasArgument(argc, argv, "--profile");
+
+	// --trace captures cpu zones from startup and writes trace.json (chrome trace format, also opens in perfetto) on exit
+	const bool trace = hasArgument(argc, argv, "--trace");
+	TRACE_THREAD_NAME("main");
+	if (trace)
+		Trace::Start();
+
+	// --workers [count] sizes the job system, the main thread counts as one. defaults to every hardware thread
+	const std::optional<std::string_view> workers = getArgumentValue(argc, argv, "--workers");
+	const std::optional<uint32_t> workerCount = workers.has_value() ? parseCount("--workers", workers.value()) : std::nullopt;
+	if (workerCount.has_value())
+		JobSystem::Init(workerCount.value());
+	else
+		JobSystem::Init();
+	Logging::Info("job system running {} workers", JobSystem::GetWorkerCount());
+
+	// --frames-in-flight [1-4], more frames trade input latency for throughput
+	const std::optional<std::string_view> framesInFlight = getArgumentValue(argc, argv, "--frames-in-flight");
+	const std::optional<uint32_t> frameSlots = framesInFlight.has_value() ? parseCount("--frames-in-flight", framesInFlight.value()) : std::nullopt;
+	if (frameSlots.has_value())
+		Renderer::setFramesInFlight(frameSlots.value());
+
+	// --colonists [count] spawns wandering colonists
+	const std::optional<std::string_view> colonists = getArgumentValue(argc, argv, "--colonists");
+	Simulation simulation;
+	simulation.create();
+	const std::optional<uint32_t> colonistCount = colonists.has_value() ? parseCount("--colonists", colonists.value()) : std::nullopt;
+	if (colonistCount.has_value())
+		simulation.spawnColonists(colonistCount.value());
+
+	// --headless [frame count]
+	if (argc > 1 && std::string_view(argv[1]) == "--headless")
+	{
+		// the frame count is optional, a following flag isn't one
+		const bool hasFrameCount = argc > 2 && std::isdigit(static_cast<unsigned char>(argv[2][0]));
+		uint32_t frameCount = hasFrameCount ? parseCount("--headless", argv[2]).value_or(1000) : 1000;
+		if (frameCount == 0)
+		{
+			Logging::Warning("--headless needs at least one frame, running 1000");
+			frameCount = 1000;
+		}
+		const int result = runHeadless(frameCount, simulation, profile, trace);
+		JobSystem::Shutdown();
+		return result;
+	}
+
 	Window window;
 	window.create();
 
 	Renderer renderer;
 	renderer.initVulkan(&window);
 
+	Time::Init();
 	while (!glfwWindowShouldClose(window.getGLFWWindow()))
 	{
 		glfwPollEvents();
+		Time::Update();
+		updateSimulation(simulation, renderer, false);
 		renderer.drawFrame();
 	}
 	renderer.waitIdle();
+
+	renderer.getFrameStats().logSummary();
+	if (profile)
+		exportProfile(renderer);
+	if (trace)
+		exportTrace();
+
+	renderer.cleanup();
+	JobSystem::Shutdown();
 }